@@ -18,10 +18,13 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
 #include <string>
+#include <memory>
 #include <cstddef>
 #include <stdint.h>
+#include <f1x/aasdk/Common/DataPool.hpp>
 
 namespace f1x
 {
@@ -30,7 +33,7 @@ namespace aasdk
 namespace common
 {
 
-typedef std::vector<uint8_t> Data;
+typedef std::vector<uint8_t, DataAllocator<uint8_t>> Data;
 
 static constexpr size_t cStaticDataSize = 30 * 1024 * 1024;
 
@@ -47,10 +50,13 @@ struct DataBuffer
     Data::size_type size;
 };
 
+struct DataSlice;
+
 struct DataConstBuffer
 {
     DataConstBuffer();
     explicit DataConstBuffer(const DataBuffer& other);
+    explicit DataConstBuffer(const DataSlice& slice);
     DataConstBuffer(const Data::value_type* _data, Data::size_type _size, Data::size_type offset = 0);
     DataConstBuffer(const void* _data, Data::size_type _size, Data::size_type offset = 0);
     explicit DataConstBuffer(const Data& _data, Data::size_type offset = 0);
@@ -61,6 +67,40 @@ struct DataConstBuffer
     Data::size_type size;
 };
 
+// Read-only view that keeps its backing storage alive. Slices handed out by
+// the transport point straight into receive storage instead of owning a copy.
+struct DataSlice
+{
+    DataSlice();
+    DataSlice(Data _data);
+    DataSlice(std::shared_ptr<const void> _owner, const DataConstBuffer& buffer);
+    bool operator==(const std::nullptr_t&) const;
+    bool operator==(const Data& _data) const;
+
+    std::shared_ptr<const void> owner;
+    const Data::value_type* cdata;
+    Data::size_type size;
+};
+
+// Outgoing data in two parts, owned head bytes (e.g. frame header and frame size)
+// followed by a payload slice that is written out without being copied.
+struct DataSequence
+{
+    DataSequence();
+    DataSequence(Data _head);
+    DataSequence(Data _head, DataSlice _payload);
+    Data::size_type size() const;
+    bool operator==(const Data& _data) const;
+
+    Data head;
+    DataSlice payload;
+};
+
+// Buffers written back to back.
+typedef std::array<DataConstBuffer, 2> DataConstBufferSequence;
+
+DataConstBufferSequence createBufferSequence(const DataSequence& sequence);
+
 template<typename DataType>
 void copy(DataType& data, const DataBuffer& buffer)
 {
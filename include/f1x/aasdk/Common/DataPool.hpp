@@ -0,0 +1,113 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+#include <cstddef>
+#include <stdint.h>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace common
+{
+
+// Process wide cache of buffers in the size classes the protocol uses: frame headers,
+// frame sizes and message ids (2 and 6 bytes), shared_ptr control blocks, control
+// messages and whole frames (16384 bytes of payload plus the frame header and size).
+class DataPool
+{
+public:
+    struct Statistics
+    {
+        uint64_t poolAllocations;
+        uint64_t heapAllocations;
+        uint64_t deallocations;
+    };
+
+    static void* allocate(size_t size);
+    static void deallocate(void* pointer, size_t size);
+
+    static Statistics getStatistics();
+    static void resetStatistics();
+
+private:
+    static std::atomic<uint64_t> poolAllocations_;
+    static std::atomic<uint64_t> heapAllocations_;
+    static std::atomic<uint64_t> deallocations_;
+};
+
+// Optionally keeps headroom bytes in front of every allocation, so a header can be put
+// in front of the data without moving it (see Message payloads and MessageOutStream).
+template<typename T>
+class DataAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    explicit DataAllocator(size_t headroom = 0)
+        : headroom_(headroom)
+    {
+    }
+
+    template<typename U>
+    DataAllocator(const DataAllocator<U>& other)
+        : headroom_(other.getHeadroom())
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        auto block = static_cast<uint8_t*>(DataPool::allocate(count * sizeof(T) + headroom_));
+        return reinterpret_cast<T*>(block + headroom_);
+    }
+
+    void deallocate(T* pointer, size_t count)
+    {
+        DataPool::deallocate(reinterpret_cast<uint8_t*>(pointer) - headroom_, count * sizeof(T) + headroom_);
+    }
+
+    size_t getHeadroom() const
+    {
+        return headroom_;
+    }
+
+private:
+    size_t headroom_;
+};
+
+template<typename T, typename U>
+bool operator==(const DataAllocator<T>& left, const DataAllocator<U>& right)
+{
+    return left.getHeadroom() == right.getHeadroom();
+}
+
+template<typename T, typename U>
+bool operator!=(const DataAllocator<T>& left, const DataAllocator<U>& right)
+{
+    return !(left == right);
+}
+
+}
+}
+}
@@ -62,7 +62,11 @@ enum class ErrorCode
     OPERATION_ABORTED = 30,
     OPERATION_IN_PROGRESS = 31,
     PARSE_PAYLOAD = 32,
-    TCP_TRANSFER = 33
+    TCP_TRANSFER = 33,
+    DATA_SINK_MEMORY_MAPPING = 34,
+    USB_INCOMPLETE_TRANSFER = 35,
+    USB_DEVICE_MEMORY_ALLOCATION = 36,
+    MESSENGER_MESSAGE_SIZE_LIMIT = 37
 };
 
 }
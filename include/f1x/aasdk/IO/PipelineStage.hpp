@@ -0,0 +1,81 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <boost/asio.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace io
+{
+
+// Executor of one stage of the messenger pipeline (transport, crypto or channel dispatch),
+// an io_service run by a thread of its own. Jobs posted to the stage run one at a time, in the
+// order they were posted. Busy time is the CPU time of the stage thread, whatever it ran.
+class PipelineStage: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<PipelineStage> Pointer;
+
+    struct Statistics
+    {
+        size_t queueDepth;
+        size_t maxQueueDepth;
+        uint64_t processedJobsCount;
+        std::chrono::microseconds busyTime;
+        std::chrono::microseconds elapsedTime;
+        double utilization;
+    };
+
+    PipelineStage();
+    ~PipelineStage();
+
+    boost::asio::io_service& getIOService();
+    void post(std::function<void()> job);
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    std::chrono::microseconds getThreadCPUTime() const;
+
+    boost::asio::io_service ioService_;
+    boost::asio::io_service::work work_;
+
+    mutable std::mutex statisticsMutex_;
+    size_t queueDepth_;
+    size_t maxQueueDepth_;
+    uint64_t processedJobsCount_;
+    std::chrono::microseconds busyTimeOrigin_;
+    std::chrono::steady_clock::time_point elapsedTimeOrigin_;
+
+    std::thread thread_;
+    std::thread::native_handle_type threadHandle_;
+};
+
+}
+}
+}
@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include <deque>
+#include <mutex>
 #include <unordered_map>
-#include <queue>
 #include <f1x/aasdk/Messenger/Message.hpp>
+#include <f1x/aasdk/Messenger/ReceiveQueuePolicy.hpp>
 
 
 namespace f1x
@@ -33,14 +35,43 @@ namespace messenger
 class ChannelReceiveMessageQueue
 {
 public:
+    struct Statistics
+    {
+        size_t queueDepth;
+        size_t maxQueueDepth;
+        uint64_t droppedMessagesCount;
+        uint64_t blockedCount;
+    };
+
+    // Every channel is unbounded until a policy is set for it
+    void setPolicy(ChannelId channelId, ReceiveQueuePolicy policy, size_t limit);
     void push(Message::Pointer message);
     Message::Pointer pop(ChannelId channelId);
     bool empty(ChannelId channelId) const;
+    bool blocked() const;
     void clear();
 
+    Statistics getStatistics(ChannelId channelId) const;
+
 private:
-    typedef std::queue<Message::Pointer> MessageQueue;
-    std::unordered_map<ChannelId, MessageQueue> queue_;
+    struct Channel
+    {
+        Channel();
+
+        ReceiveQueuePolicy policy;
+        size_t limit;
+        bool waitingForKeyFrame;
+        std::deque<Message::Pointer> queue;
+        Statistics statistics;
+    };
+
+    void dropUntilKeyFrame(Channel& channel, Message::Pointer message);
+    void dropMedia(Channel& channel, std::deque<Message::Pointer>::iterator end);
+    static bool isMedia(const Message& message);
+    static bool isKeyFrame(const Message& message);
+
+    std::unordered_map<ChannelId, Channel> channels_;
+    mutable std::mutex mutex_;
 };
 
 }
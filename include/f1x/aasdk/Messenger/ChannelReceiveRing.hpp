@@ -0,0 +1,89 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+#include <f1x/aasdk/Messenger/Message.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+// Single producer, single consumer ring of received messages of one channel. The messenger receive strand
+// produces, a thread owned by the application consumes without going through promises and strands.
+class ChannelReceiveRing: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<ChannelReceiveRing> Pointer;
+
+    // capacity is rounded up to a power of two
+    ChannelReceiveRing(size_t capacity);
+
+    // producer side, a message that does not fit is dropped and counted. A producer that must not lose
+    // messages checks full() first and holds them back until the handler passed to notifyOnSpace() is
+    // called from the consumer thread.
+    bool push(Message::Pointer message);
+    bool full() const;
+    void notifyOnSpace(std::function<void()> handler);
+    void close(const error::Error& e = error::Error());
+
+    // consumer side, nullptr when the ring is empty, or closed and drained
+    Message::Pointer tryPop();
+    Message::Pointer pop();
+    Message::Pointer pop(std::chrono::milliseconds timeout);
+
+    bool isClosed() const;
+    error::Error getError() const;
+    size_t getCapacity() const;
+    uint64_t getDroppedMessagesCount() const;
+
+private:
+    bool ready() const;
+    void notify();
+    void notifySpace();
+
+    std::vector<Message::Pointer> slots_;
+    const size_t mask_;
+
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) std::atomic<bool> closed_;
+    std::atomic<bool> waiting_;
+    std::atomic<bool> spaceWanted_;
+    std::atomic<uint64_t> droppedMessagesCount_;
+    error::Error error_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::function<void()> spaceHandler_;
+};
+
+}
+}
+}
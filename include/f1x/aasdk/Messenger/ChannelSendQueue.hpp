@@ -0,0 +1,104 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <f1x/aasdk/Messenger/IMessenger.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+// Outgoing messages queued per channel. Every channel belongs to a send class. Classes with a lower
+// priority value are always served first, classes of the same priority share the link in proportion
+// to their weights (weighted fair queuing by payload size). Messages of one channel keep their order,
+// a popped channel stays busy and is skipped until it is released.
+class ChannelSendQueue
+{
+public:
+    struct Statistics
+    {
+        size_t queueDepth;
+        size_t maxQueueDepth;
+        uint64_t sentMessagesCount;
+        std::chrono::microseconds totalWaitTime;
+        std::chrono::microseconds maxWaitTime;
+    };
+
+    ChannelSendQueue();
+
+    void setClass(size_t classId, size_t priority, size_t weight);
+    void setChannelClass(ChannelId channelId, size_t classId);
+
+    void push(Message::Pointer message, SendPromise::Pointer promise);
+    std::pair<Message::Pointer, SendPromise::Pointer> pop();
+    void release(ChannelId channelId);
+    bool ready() const;
+    // a channel of the class with the lowest priority value has a message to pop
+    bool readyAtTopPriority() const;
+    void reject(const error::Error& e);
+
+    std::vector<Statistics> getStatistics() const;
+    void resetStatistics();
+
+private:
+    struct QueueElement
+    {
+        Message::Pointer message;
+        SendPromise::Pointer promise;
+        std::chrono::steady_clock::time_point enqueueTime;
+    };
+
+    struct Channel
+    {
+        size_t classId;
+        uint64_t startTag;
+        uint64_t finishTag;
+        bool busy;
+        std::deque<QueueElement> queue;
+    };
+
+    struct Class
+    {
+        size_t priority;
+        size_t weight;
+    };
+
+    Channel& getChannel(ChannelId channelId);
+
+    std::map<ChannelId, Channel> channels_;
+    std::vector<Class> classes_;
+    uint64_t virtualTime_;
+
+    mutable std::mutex statisticsMutex_;
+    std::vector<Statistics> statistics_;
+
+    static constexpr uint64_t cWeightScale = 1024;
+};
+
+}
+}
+}
@@ -18,9 +18,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <f1x/aasdk/Transport/ISSLWrapper.hpp>
 #include <f1x/aasdk/Messenger/ICryptor.hpp>
+#include <f1x/aasdk/Messenger/RecordCipher.hpp>
 
 namespace f1x
 {
@@ -32,20 +34,30 @@ namespace messenger
 class Cryptor: public ICryptor
 {
 public:
-    Cryptor(transport::ISSLWrapper::Pointer sslWrapper);
+    // directRecordLayer protects records with the exported session keys after the handshake, bypassing the BIOs.
+    // Only then do encryption and decryption run concurrently, otherwise both go through one SSL object in turn.
+    Cryptor(transport::ISSLWrapper::Pointer sslWrapper, bool directRecordLayer = false);
 
     void init() override;
     void deinit() override;
     bool doHandshake() override;
     size_t encrypt(common::Data& output, const common::DataConstBuffer& buffer) override;
+    std::vector<size_t> encryptBatch(std::vector<common::Data>& outputs, const std::vector<common::DataConstBuffer>& buffers) override;
     size_t decrypt(common::Data& output, const common::DataConstBuffer& buffer) override;
+    size_t decryptInto(common::DataBuffer output, const common::DataConstBuffer& buffer) override;
 
     common::Data readHandshakeBuffer() override;
     void writeHandshakeBuffer(const common::DataConstBuffer& buffer) override;
     bool isActive() const override;
 
 private:
+    void lockSSL(std::unique_lock<std::mutex>& readLock, std::unique_lock<std::mutex>& writeLock);
+    void startDirectRecordLayer();
+    void startDirectWrite();
+    void findFinishedExplicitNonce(const common::Data& records);
+    void doEncrypt(const common::DataConstBuffer& buffer);
     size_t read(common::Data& output);
+    size_t read(common::Data& output, size_t pendingSize);
     void write(const common::DataConstBuffer& buffer);
 
     transport::ISSLWrapper::Pointer sslWrapper_;
@@ -55,11 +67,18 @@ private:
     SSL_CTX* context_;
     SSL* ssl_;
     transport::ISSLWrapper::BIOs bIOs_;
-    bool isActive_;
+    std::atomic<bool> isActive_;
+    bool directRecordLayer_;
+    RecordCipher::Pointer writeCipher_;
+    RecordCipher::Pointer readCipher_;
+    transport::ISSLWrapper::RecordKeys recordKeys_;
+    common::Data finishedExplicitNonce_;
 
     const static std::string cCertificate;
     const static std::string cPrivateKey;
-    mutable std::mutex mutex_;
+    // both are taken for anything that goes through the SSL object, a direction that has its record cipher takes only its own
+    std::mutex readMutex_;
+    std::mutex writeMutex_;
 };
 
 }
@@ -37,6 +37,7 @@ public:
 
     common::Data getData() const;
     size_t getSize() const;
+    size_t getTotalSize() const;
 
     static size_t getSizeOf(FrameSizeType type);
 
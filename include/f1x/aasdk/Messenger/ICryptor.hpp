@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <f1x/aasdk/Common/Data.hpp>
 
 namespace f1x
@@ -40,10 +41,17 @@ public:
     virtual void deinit() = 0;
     virtual bool doHandshake() = 0;
     virtual size_t encrypt(common::Data& output, const common::DataConstBuffer& buffer) = 0;
+    // each buffer becomes its own record appended to the matching output, returns the encrypted sizes
+    virtual std::vector<size_t> encryptBatch(std::vector<common::Data>& outputs, const std::vector<common::DataConstBuffer>& buffers) = 0;
     virtual size_t decrypt(common::Data& output, const common::DataConstBuffer& buffer) = 0;
+    // output is sized by the caller, a record never decrypts to more than its own size, returns the plaintext size
+    virtual size_t decryptInto(common::DataBuffer output, const common::DataConstBuffer& buffer) = 0;
     virtual common::Data readHandshakeBuffer() = 0;
     virtual void writeHandshakeBuffer(const common::DataConstBuffer& buffer) = 0;
     virtual bool isActive() const = 0;
+
+    // TLS 1.2 bound on how much bigger a record is than its plaintext
+    static constexpr size_t cMaxRecordExpansionSize = 2048;
 };
 
 }
@@ -47,6 +47,9 @@ public:
     EncryptionType getEncryptionType() const;
     MessageType getType() const;
 
+    // gives the message new header fields and empties the payload, its capacity is kept
+    void reset(ChannelId channelId, EncryptionType encryptionType, MessageType type);
+
     common::Data& getPayload();
     const common::Data& getPayload() const;
     void insertPayload(const common::Data& payload);
@@ -54,6 +57,9 @@ public:
     void insertPayload(const common::DataConstBuffer& buffer);
     void insertPayload(common::DataBuffer& buffer);
 
+    // room for the frame header and the short frame size in front of the payload
+    static constexpr size_t cPayloadHeadroomSize = 4;
+
 private:
     ChannelId channelId_;
     EncryptionType encryptionType_;
@@ -18,7 +18,11 @@
 
 #pragma once
 
+#include <array>
+#include <deque>
 #include <f1x/aasdk/Transport/ITransport.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+#include <f1x/aasdk/IO/PipelineStage.hpp>
 #include <f1x/aasdk/Messenger/IMessageInStream.hpp>
 #include <f1x/aasdk/Messenger/ICryptor.hpp>
 #include <f1x/aasdk/Messenger/FrameHeader.hpp>
@@ -34,23 +38,76 @@ namespace messenger
 class MessageInStream: public IMessageInStream, public std::enable_shared_from_this<MessageInStream>, boost::noncopyable
 {
 public:
-    MessageInStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor);
+    // messages bigger than maxMessageSize fail the receive with MESSENGER_MESSAGE_SIZE_LIMIT
+    // with a crypto stage, frames are decrypted on its thread while following frames are received and parsed
+    MessageInStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor, size_t maxMessageSize = cDefaultMaxMessageSize,
+                    io::PipelineStage::Pointer cryptoStage = nullptr);
 
     void startReceive(ReceivePromise::Pointer promise) override;
 
 private:
+    enum class ParserState
+    {
+        FRAME_HEADER,
+        FRAME_SIZE,
+        FRAME_PAYLOAD
+    };
+
+    struct CompletedMessage
+    {
+        Message::Pointer message;
+        // the message is complete once this many decryptions are done
+        uint64_t decryptionsCount;
+    };
+
     using std::enable_shared_from_this<MessageInStream>::shared_from_this;
 
-    void receiveFrameHeaderHandler(const common::DataConstBuffer& buffer);
-    void receiveFrameSizeHandler(const common::DataConstBuffer& buffer);
-    void receiveFramePayloadHandler(const common::DataConstBuffer& buffer);
+    void receive();
+    void receivePipelined();
+    void receiveFromTransport();
+    void deliver();
+    bool isPipelineFull() const;
+    void postDecryption(const common::DataConstBuffer& buffer);
+    void decryptionHandler(uint64_t generation, const error::Error& e);
+    void fail(const error::Error& e);
+    void reset();
+    void reject(const error::Error& e);
+    Message::Pointer parse();
+    bool parseFrameHeader();
+    bool parseFrameSize();
+    bool parseFramePayload();
+    void decryptFramePayload(Message& message, const common::DataConstBuffer& buffer, size_t reserveSize) const;
+    void checkMessageSize(size_t size) const;
+    bool take(size_t size, common::DataConstBuffer& buffer);
+    void skip(size_t size);
 
     boost::asio::io_service::strand strand_;
     transport::ITransport::Pointer transport_;
     ICryptor::Pointer cryptor_;
-    FrameType recentFrameType_;
     ReceivePromise::Pointer promise_;
     Message::Pointer message_;
+    // multi-frame messages are reassembled per channel, frames of different channels may interleave
+    std::array<Message::Pointer, 256> channelMessages_;
+    ParserState state_;
+    FrameType recentFrameType_;
+    size_t framePayloadSize_;
+    size_t payloadReserveSize_;
+    common::DataSlice receivedData_;
+    common::Data partialData_;
+    size_t maxMessageSize_;
+
+    io::PipelineStage::Pointer cryptoStage_;
+    // decryptions finish in the order they were posted, messages are delivered in the order they were parsed
+    std::deque<CompletedMessage> completedMessages_;
+    uint64_t decryptionsCount_;
+    uint64_t finishedDecryptionsCount_;
+    // decryptions posted before a failure are ignored
+    uint64_t generation_;
+    bool isReceiving_;
+    error::Error error_;
+
+    static constexpr size_t cDefaultMaxMessageSize = 16 * 1024 * 1024;
+    static constexpr size_t cMaxPipelineDepth = 8;
 };
 
 }
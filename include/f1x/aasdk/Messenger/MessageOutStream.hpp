@@ -18,7 +18,11 @@
 
 #pragma once
 
+#include <deque>
+#include <functional>
+#include <vector>
 #include <f1x/aasdk/Common/Data.hpp>
+#include <f1x/aasdk/IO/PipelineStage.hpp>
 #include <f1x/aasdk/Transport/ITransport.hpp>
 #include <f1x/aasdk/Messenger/ICryptor.hpp>
 #include <f1x/aasdk/Messenger/IMessageOutStream.hpp>
@@ -35,29 +39,52 @@ namespace messenger
 class MessageOutStream: public IMessageOutStream, public std::enable_shared_from_this<MessageOutStream>, boost::noncopyable
 {
 public:
-    MessageOutStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor);
+    // with a crypto stage, frames are encrypted on its thread and handed to the transport in the order they were encrypted
+    MessageOutStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor, io::PipelineStage::Pointer cryptoStage = nullptr);
 
     void stream(Message::Pointer message, SendPromise::Pointer promise) override;
 
 private:
     using std::enable_shared_from_this<MessageOutStream>::shared_from_this;
 
+    struct SplittedMessage
+    {
+        Message::Pointer message;
+        SendPromise::Pointer promise;
+        size_t offset;
+    };
+
+    struct PendingMessage
+    {
+        Message::Pointer message;
+        SendPromise::Pointer promise;
+    };
+
+    void streamSingleFrameMessage(Message::Pointer message, SendPromise::Pointer promise);
+    void streamEncryptedMessages();
     void streamSplittedMessage();
-    common::Data compoundFrame(FrameType frameType, const common::DataConstBuffer& payloadBuffer);
+    void sendFrame(common::DataSequence data, SendPromise::Pointer promise);
+    void sendSplittedFrame(FrameType frameType, common::DataSequence data);
+    void rejectSplittedMessage(const error::Error& e);
+    void rejectSplittedMessages(const error::Error& e);
+    void postEncryption(std::function<void()> encryption, std::function<void(const error::Error&)> handler);
+    void encryptFrames(std::vector<common::Data>& frames, const std::vector<common::DataConstBuffer>& payloadBuffers);
+    common::DataSequence compoundFrame(const Message::Pointer& message, FrameType frameType, const common::DataConstBuffer& payloadBuffer);
+    bool hasFrameHeadroom(const Message& message) const;
+    common::DataSequence compoundFrameInPlace(const Message::Pointer& message);
     void streamEncryptedFrame(FrameType frameType, const common::DataConstBuffer& payloadBuffer);
     void streamPlainFrame(FrameType frameType, const common::DataConstBuffer& payloadBuffer);
     void setFrameSize(common::Data& data, FrameType frameType, size_t payloadSize, size_t totalSize);
-    void reset();
 
     boost::asio::io_service::strand strand_;
     transport::ITransport::Pointer transport_;
     ICryptor::Pointer cryptor_;
-    Message::Pointer message_;
-    size_t offset_;
-    size_t remainingSize_;
-    SendPromise::Pointer promise_;
+    io::PipelineStage::Pointer cryptoStage_;
+    // messages bigger than a single frame, their fragments are sent in turns, one at a time
+    std::deque<SplittedMessage> splittedMessages_;
+    std::vector<PendingMessage> encryptedMessages_;
 
-        static constexpr size_t cMaxFramePayloadSize = 0x4000;
+    static constexpr size_t cMaxFramePayloadSize = 0x4000;
 };
 
 }
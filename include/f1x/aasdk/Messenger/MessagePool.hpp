@@ -0,0 +1,67 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <f1x/aasdk/Messenger/Message.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+// Process wide cache of Message objects. A released message goes back to the pool together with its payload
+// capacity, its shared_ptr control block is taken from common::DataPool. Steady streams of small messages
+// (sensor, input, audio) get by without touching the heap.
+class MessagePool
+{
+public:
+    struct Statistics
+    {
+        uint64_t poolAllocations;
+        uint64_t heapAllocations;
+        uint64_t recycledMessages;
+        // payload capacity currently held by the pooled messages, not affected by resetStatistics()
+        size_t pooledPayloadSize;
+    };
+
+    static Message::Pointer create(ChannelId channelId, EncryptionType encryptionType, MessageType type);
+
+    static Statistics getStatistics();
+    static void resetStatistics();
+
+private:
+    static void recycle(Message* message);
+
+    static std::atomic<uint64_t> poolAllocations_;
+    static std::atomic<uint64_t> heapAllocations_;
+    static std::atomic<uint64_t> recycledMessages_;
+
+    // messages with a bigger payload capacity (e.g. video frames) are not kept, nor are messages that would
+    // push the payload capacity held by the pool over cMaxPooledPayloadSize
+    static constexpr size_t cMaxPooledMessagesCount = 256;
+    static constexpr size_t cMaxPooledPayloadCapacity = 64 * 1024;
+    static constexpr size_t cMaxPooledPayloadSize = 1024 * 1024;
+};
+
+}
+}
+}
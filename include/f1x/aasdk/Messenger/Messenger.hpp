@@ -18,13 +18,17 @@
 
 #pragma once
 
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <boost/asio.hpp>
-#include <list>
 #include <f1x/aasdk/Messenger/IMessenger.hpp>
 #include <f1x/aasdk/Messenger/IMessageInStream.hpp>
 #include <f1x/aasdk/Messenger/IMessageOutStream.hpp>
 #include <f1x/aasdk/Messenger/ChannelReceiveMessageQueue.hpp>
 #include <f1x/aasdk/Messenger/ChannelReceivePromiseQueue.hpp>
+#include <f1x/aasdk/Messenger/ChannelReceiveRing.hpp>
+#include <f1x/aasdk/Messenger/ChannelSendQueue.hpp>
 
 namespace f1x
 {
@@ -41,13 +45,35 @@ public:
     void enqueueSend(Message::Pointer message, SendPromise::Pointer promise) override;
     void stop() override;
 
+    // Send scheduling, see ChannelSendQueue. By default control, input, sensor and bluetooth channels (class 0)
+    // go before audio (class 1), which goes before video and microphone data (class 2).
+    void setSendClass(size_t classId, size_t priority, size_t weight);
+    void setChannelSendClass(ChannelId channelId, size_t classId);
+    std::vector<ChannelSendQueue::Statistics> getSendStatistics() const;
+    // Number of messages streamed at once. The scheduler picks the next message only when one of them is sent,
+    // so a larger window lets more channels interleave frames at the cost of priority. One more slot is kept
+    // for the top priority class (e.g. input), which joins the frames in flight instead of waiting for a whole
+    // bulk transfer.
+    void setSendWindow(size_t size);
+
+    // Messages received for a channel without a pending receive are queued, see ReceiveQueuePolicy
+    void setReceiveQueuePolicy(ChannelId channelId, ReceiveQueuePolicy policy, size_t limit);
+    ChannelReceiveMessageQueue::Statistics getReceiveStatistics(ChannelId channelId) const;
+
+    // Pull mode: messages of the channel go to the returned ring instead of receive promises. The ring is
+    // closed by closeReceiveRing(), stop() or a receive error. Reading stops while the ring is full.
+    ChannelReceiveRing::Pointer openReceiveRing(ChannelId channelId, size_t capacity);
+    void closeReceiveRing(ChannelId channelId);
+
 private:
     using std::enable_shared_from_this<Messenger>::shared_from_this;
-    typedef std::list<std::pair<Message::Pointer, SendPromise::Pointer>> ChannelSendQueue;
     void doSend();
+    void startReceive();
     void inStreamMessageHandler(Message::Pointer message);
-    void outStreamMessageHandler(ChannelSendQueue::iterator queueElement);
+    void outStreamMessageHandler(ChannelId channelId);
     void rejectReceivePromiseQueue(const error::Error& e);
+    void closeReceiveRings(const error::Error& e);
+    void fillReceiveRing(ChannelId channelId);
     void rejectSendPromiseQueue(const error::Error& e);
 
     boost::asio::io_service::strand receiveStrand_;
@@ -57,7 +83,16 @@ private:
 
     ChannelReceivePromiseQueue channelReceivePromiseQueue_;
     ChannelReceiveMessageQueue channelReceiveMessageQueue_;
+    std::unordered_map<ChannelId, ChannelReceiveRing::Pointer> channelReceiveRings_;
+    // channels whose ring is full, their messages wait in channelReceiveMessageQueue_
+    std::unordered_set<ChannelId> fullReceiveRings_;
+    bool receiving_;
     ChannelSendQueue channelSendPromiseQueue_;
+    // at most sendWindow_ messages, one per channel, are streamed at a time, plus one of the top priority class
+    std::map<ChannelId, SendPromise::Pointer> sendPromises_;
+    size_t sendWindow_;
+
+    static constexpr size_t cDefaultSendWindow = 2;
 };
 
 }
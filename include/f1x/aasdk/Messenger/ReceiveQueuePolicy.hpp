@@ -0,0 +1,47 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+// What happens to a message received for a channel whose receive queue is full.
+// The drop policies are meant for channels nothing waits on. A dropped AV_MEDIA indication is never
+// acknowledged with AV_MEDIA_ACK, so on audio/video channels, where the phone stops sending once it runs
+// out of unacknowledged frames, the application has to ack droppedMessagesCount frames itself.
+enum class ReceiveQueuePolicy
+{
+    // the queue never fills up, this is the default for every channel
+    UNBOUNDED,
+    // the message is queued and reading from the stream stops until the application drains the channel
+    BLOCK,
+    // the oldest queued message is dropped
+    DROP_OLDEST,
+    // queued audio/video media is dropped and so is the incoming media until the next key frame,
+    // other messages of the channel are kept
+    DROP_UNTIL_KEY_FRAME
+};
+
+}
+}
+}
@@ -0,0 +1,72 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <openssl/evp.h>
+#include <f1x/aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+// TLS 1.2 AEAD record protection for one direction of an established session, done with EVP straight
+// into the destination buffer instead of going through SSL_write/SSL_read and the memory BIOs.
+class RecordCipher: boost::noncopyable
+{
+public:
+    typedef std::unique_ptr<RecordCipher> Pointer;
+
+    // iv is the fixed part of the nonce, explicitNonce is the first explicit nonce sent when encrypting
+    RecordCipher(const EVP_CIPHER* cipher, const common::Data& key, const common::Data& iv, size_t explicitNonceSize,
+                 bool encryption, uint64_t sequenceNumber = 0, uint64_t explicitNonce = 0);
+    ~RecordCipher();
+
+    // appends application data records, split like SSL_write does
+    size_t encrypt(common::Data& output, const common::DataConstBuffer& buffer);
+    // plaintext of all complete records, a trailing partial record waits for the next call
+    size_t decrypt(common::Data& output, const common::DataConstBuffer& buffer);
+    size_t decrypt(common::DataBuffer output, const common::DataConstBuffer& buffer);
+
+    static constexpr size_t cHeaderSize = 5;
+    static constexpr size_t cTagSize = 16;
+    static constexpr size_t cMaxPayloadSize = 0x4000;
+
+private:
+    size_t encryptRecord(common::Data& output, const common::DataConstBuffer& buffer);
+    size_t decryptRecord(common::DataBuffer output, const common::DataConstBuffer& record);
+    bool setNonce(const uint8_t* explicitNonce);
+    bool setAdditionalData(uint8_t type, size_t size);
+
+    EVP_CIPHER_CTX* context_;
+    common::Data iv_;
+    size_t explicitNonceSize_;
+    bool encryption_;
+    uint64_t sequenceNumber_;
+    uint64_t explicitNonce_;
+    common::Data pendingRecord_;
+};
+
+}
+}
+}
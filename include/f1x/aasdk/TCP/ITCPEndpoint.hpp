@@ -38,7 +38,7 @@ public:
 
     virtual ~ITCPEndpoint() = default;
 
-    virtual void send(common::DataConstBuffer buffer, Promise::Pointer promise) = 0;
+    virtual void send(common::DataConstBufferSequence buffers, Promise::Pointer promise) = 0;
     virtual void receive(common::DataBuffer buffer, Promise::Pointer promise) = 0;
     virtual void stop() = 0;
 };
@@ -37,7 +37,7 @@ public:
 
     virtual ~ITCPWrapper() = default;
 
-    virtual void asyncWrite(boost::asio::ip::tcp::socket& socket, common::DataConstBuffer buffer, Handler handler) = 0;
+    virtual void asyncWrite(boost::asio::ip::tcp::socket& socket, common::DataConstBufferSequence buffers, Handler handler) = 0;
     virtual void asyncRead(boost::asio::ip::tcp::socket& socket, common::DataBuffer buffer, Handler handler) = 0;
     virtual void close(boost::asio::ip::tcp::socket& socket) = 0;
     virtual void asyncConnect(boost::asio::ip::tcp::socket& socket, const std::string& hostname, uint16_t port, ConnectHandler handler) = 0;
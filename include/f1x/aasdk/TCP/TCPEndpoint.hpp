@@ -34,7 +34,7 @@ class TCPEndpoint: public ITCPEndpoint, public std::enable_shared_from_this<TCPE
 public:
     TCPEndpoint(ITCPWrapper& tcpWrapper, SocketPointer socket);
 
-    void send(common::DataConstBuffer buffer, Promise::Pointer promise) override;
+    void send(common::DataConstBufferSequence buffers, Promise::Pointer promise) override;
     void receive(common::DataBuffer buffer, Promise::Pointer promise) override;
     void stop() override;
 
@@ -18,10 +18,13 @@
 
 #pragma once
 
-#include <limits>
-#include <boost/circular_buffer.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
 #include <f1x/aasdk/Common/Data.hpp>
-
+#include <f1x/aasdk/Transport/IDataSinkStorage.hpp>
 
 namespace f1x
 {
@@ -33,17 +36,78 @@ namespace transport
 class DataSink
 {
 public:
-    DataSink();
+    // Starts small and grows on demand up to capacityLimit.
+    explicit DataSink(common::Data::size_type capacityLimit = common::cStaticDataSize);
+    // Fixed size sink on top of the given storage.
+    explicit DataSink(IDataSinkStorage::Pointer storage);
 
+    // Reserves the next chunk. Several chunks may be outstanding, they are committed in the order they were reserved.
+    // Returns an empty buffer when there is no room and the space is still referenced by slices or outstanding chunks.
     common::DataBuffer fill();
     void commit(common::Data::size_type size);
 
     common::Data::size_type getAvailableSize();
-    common::Data consume(common::Data::size_type size);
+    // Part of the available data that the next consume can return without gathering it into a copy.
+    common::Data::size_type getContiguousSize() const;
+    common::DataSlice consume(common::Data::size_type size);
+
+    // Calls the handler once, from the thread that releases the slice, when slices give back space
+    // after fill() ran out of it. Called right away if the space is already free.
+    void notifyOnRelease(std::function<void()> handler);
+    void cancelReleaseNotification();
+
+    common::Data::size_type getCapacity() const;
+    common::Data::size_type getCapacityLimit() const;
+    common::Data::size_type getHighWaterMark() const;
+
+    static IDataSinkStorage::Pointer createStorage(common::Data::size_type capacity);
 
 private:
-    boost::circular_buffer<common::Data::value_type> data_;
+    typedef std::shared_ptr<IDataSinkStorage::Pointer> Page;
+
+    // shared with the pages, which may be released after the sink is gone
+    struct ReleaseNotifier
+    {
+        void notify();
+
+        std::mutex mutex;
+        std::function<void()> handler;
+    };
+
+    DataSink(IDataSinkStorage::Pointer storage, common::Data::size_type capacityLimit);
+    void setStorage(IDataSinkStorage::Pointer storage);
+    Page getPage(size_t index);
+    void resize(common::Data::size_type capacity);
+    void shrinkIfIdle();
+    void updateReadPosition();
+    common::Data::size_type getFreeSize() const;
+    common::Data::value_type* getPointer(uint64_t position);
+    void updateMirror(uint64_t position, common::Data::size_type size);
+    void reclaim();
+
+    IDataSinkStorage::Pointer storage_;
+    common::Data::size_type capacity_;
+    common::Data::size_type mirrorSize_;
+    common::Data::size_type pageSize_;
+    // pages exist only while slices reference them
+    std::vector<std::weak_ptr<IDataSinkStorage::Pointer>> pages_;
+    std::shared_ptr<ReleaseNotifier> releaseNotifier_;
+    uint64_t tailPosition_;
+    uint64_t readPosition_;
+    uint64_t writePosition_;
+    std::deque<std::pair<uint64_t, uint64_t>> segments_;
+    std::deque<uint64_t> windows_;
+    common::Data::size_type availableSize_;
+    common::Data::size_type initialCapacity_;
+    common::Data::size_type capacityLimit_;
+    std::atomic<common::Data::size_type> highWaterMark_;
+    common::Data::size_type recentUsedSize_;
+    size_t idleCount_;
+
     static constexpr common::Data::size_type cChunkSize = 16384;
+    static constexpr common::Data::size_type cInitialCapacity = 64 * 1024;
+    static constexpr size_t cPagesCount = 16;
+    static constexpr size_t cShrinkIdleCount = 64;
 };
 
 }
@@ -0,0 +1,49 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <f1x/aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace transport
+{
+
+class IDataSinkStorage
+{
+public:
+    typedef std::shared_ptr<IDataSinkStorage> Pointer;
+
+    IDataSinkStorage() = default;
+    virtual ~IDataSinkStorage() = default;
+
+    // Ring memory. Bytes [capacity, capacity + mirror size) alias the beginning of the ring,
+    // either by the MMU (isMirrored) or by DataSink copying them after every commit.
+    virtual common::Data::value_type* getData() = 0;
+    virtual common::Data::size_type getCapacity() const = 0;
+    virtual common::Data::size_type getMirrorSize() const = 0;
+    virtual bool isMirrored() const = 0;
+};
+
+}
+}
+}
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <openssl/ssl.h>
+#include <f1x/aasdk/Common/Data.hpp>
 
 namespace f1x
 {
@@ -34,6 +35,17 @@ public:
     typedef std::pair<BIO*, BIO*> BIOs;
     typedef std::shared_ptr<ISSLWrapper> Pointer;
 
+    // AEAD keys of an established TLS 1.2 session, write and read as seen by the local side
+    struct RecordKeys
+    {
+        const EVP_CIPHER* cipher = nullptr;
+        size_t explicitNonceSize = 0;
+        common::Data writeKey;
+        common::Data writeIV;
+        common::Data readKey;
+        common::Data readIV;
+    };
+
     ISSLWrapper() = default;
     virtual ~ISSLWrapper() = default;
 
@@ -63,6 +75,7 @@ public:
     virtual int sslRead(SSL *ssl, void *buf, int num) = 0;
     virtual int sslWrite(SSL *ssl, const void *buf, int num) = 0;
     virtual int getError(SSL* ssl, int returnCode) = 0;
+    virtual bool getRecordKeys(SSL* ssl, RecordKeys& keys) = 0;
 };
 
 }
@@ -33,14 +33,16 @@ class ITransport
 {
 public:
     typedef std::shared_ptr<ITransport> Pointer;
-    typedef io::Promise<common::Data> ReceivePromise;
+    typedef io::Promise<common::DataSlice> ReceivePromise;
     typedef io::Promise<void> SendPromise;
 
     ITransport() = default;
     virtual ~ITransport() = default;
 
     virtual void receive(size_t size, ReceivePromise::Pointer promise) = 0;
-    virtual void send(common::Data data, SendPromise::Pointer promise) = 0;
+    // Resolves with the data received so far as soon as there is any.
+    virtual void receiveAvailable(ReceivePromise::Pointer promise) = 0;
+    virtual void send(common::DataSequence data, SendPromise::Pointer promise) = 0;
     virtual void stop() = 0;
 };
 
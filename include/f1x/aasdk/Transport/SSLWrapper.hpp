@@ -46,6 +46,7 @@ public:
     void setConnectState(SSL* ssl) override;
     int doHandshake(SSL* ssl) override;
     int getError(SSL* ssl, int returnCode) override;
+    bool getRecordKeys(SSL* ssl, RecordKeys& keys) override;
 
     void free(SSL* ssl) override;
     void free(SSL_CTX* context) override;
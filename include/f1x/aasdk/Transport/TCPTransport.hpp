@@ -28,10 +28,12 @@ namespace aasdk
 namespace transport
 {
 
+// TLS records travel inside frames with plaintext headers, next to plain frames, so the socket stream is not
+// a TLS stream and kernel TLS cannot take it over. Cryptor's direct record layer is the user space counterpart.
 class TCPTransport: public Transport
 {
 public:
-    TCPTransport(boost::asio::io_service& ioService, tcp::ITCPEndpoint::Pointer tcpEndpoint);
+    TCPTransport(boost::asio::io_service& ioService, tcp::ITCPEndpoint::Pointer tcpEndpoint, size_t receiveBufferLimit = common::cStaticDataSize);
 
     void stop() override;
 
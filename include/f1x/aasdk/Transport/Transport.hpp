@@ -18,6 +18,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include <list>
 #include <queue>
 #include <boost/asio.hpp>
@@ -34,19 +37,44 @@ namespace transport
 class Transport: public ITransport, public std::enable_shared_from_this<Transport>, boost::noncopyable
 {
 public:
-    Transport(boost::asio::io_service& ioService);
+    Transport(boost::asio::io_service& ioService, size_t receiveBufferLimit = common::cStaticDataSize);
+    // Receives into a fixed size buffer on top of the given storage.
+    Transport(boost::asio::io_service& ioService, IDataSinkStorage::Pointer receiveStorage);
 
     void receive(size_t size, ReceivePromise::Pointer promise) override;
-    void send(common::Data data, SendPromise::Pointer promise) override;
+    void receiveAvailable(ReceivePromise::Pointer promise) override;
+    void send(common::DataSequence data, SendPromise::Pointer promise) override;
+    void stop() override;
+
+    size_t getReceiveBufferHighWaterMark() const;
+
+    struct SendStatistics
+    {
+        uint64_t frames;
+        uint64_t transfers;
+    };
+
+    // Merges consecutive queued frames into one transfer of up to maxTransferSize bytes.
+    // An idle link holds the first frame for at most maxLatency to let others join it.
+    void setSendCoalescing(size_t maxTransferSize, std::chrono::microseconds maxLatency);
+    SendStatistics getSendStatistics() const;
 
 protected:
     typedef std::list<std::pair<size_t, ReceivePromise::Pointer>> ReceiveQueue;
-    typedef std::list<std::pair<common::Data, SendPromise::Pointer>> SendQueue;
+    typedef std::list<std::pair<common::DataSequence, SendPromise::Pointer>> SendQueue;
 
     using std::enable_shared_from_this<Transport>::shared_from_this;
     void receiveHandler(size_t bytesTransferred);
+    void receiveErrorHandler(const error::Error& e);
     void distributeReceivedData();
     void rejectReceivePromises(const error::Error& e);
+    void waitForReceiveBuffer();
+
+    void sendNext();
+    void finishSend(SendQueue::iterator queueElement);
+    void coalesceSendQueue(SendQueue::iterator queueElement);
+    void holdSend();
+    size_t getQueuedSendSize() const;
 
     virtual void enqueueReceive(common::DataBuffer buffer) = 0;
     virtual void enqueueSend(SendQueue::iterator queueElement) = 0;
@@ -55,9 +83,22 @@ protected:
 
     boost::asio::io_service::strand receiveStrand_;
     ReceiveQueue receiveQueue_;
+    bool isWaitingForReceiveBuffer_;
+    size_t receiveQueueDepth_;
+    size_t pendingReceivesCount_;
 
     boost::asio::io_service::strand sendStrand_;
     SendQueue sendQueue_;
+    size_t sendQueueDepth_;
+    size_t pendingSendsCount_;
+    boost::asio::steady_timer sendHoldTimer_;
+    bool isSendHeld_;
+    size_t maxCoalescedSize_;
+    std::chrono::microseconds maxCoalescingLatency_;
+    std::atomic<uint64_t> sentFramesCount_;
+    std::atomic<uint64_t> transfersCount_;
+
+    static constexpr size_t cAvailableSize = std::numeric_limits<size_t>::max();
 };
 
 }
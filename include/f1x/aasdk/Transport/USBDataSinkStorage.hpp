@@ -0,0 +1,50 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <f1x/aasdk/USB/USBDeviceMemory.hpp>
+#include <f1x/aasdk/Transport/IDataSinkStorage.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace transport
+{
+
+// Receive ring in device memory, bulk IN transfers land in it without an extra kernel copy.
+class USBDataSinkStorage: public IDataSinkStorage, boost::noncopyable
+{
+public:
+    USBDataSinkStorage(usb::IUSBWrapper& usbWrapper, usb::DeviceHandle handle, common::Data::size_type capacity, common::Data::size_type mirrorSize);
+
+    common::Data::value_type* getData() override;
+    common::Data::size_type getCapacity() const override;
+    common::Data::size_type getMirrorSize() const override;
+    bool isMirrored() const override;
+
+private:
+    usb::USBDeviceMemory memory_;
+    common::Data::size_type capacity_;
+};
+
+}
+}
+}
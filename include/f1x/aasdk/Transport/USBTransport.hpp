@@ -18,9 +18,12 @@
 
 #pragma once
 
+#include <vector>
 #include <boost/asio.hpp>
 #include <f1x/aasdk/Transport/Transport.hpp>
 #include <f1x/aasdk/USB/IAOAPDevice.hpp>
+#include <f1x/aasdk/USB/IUSBWrapper.hpp>
+#include <f1x/aasdk/USB/USBDeviceMemory.hpp>
 
 namespace f1x
 {
@@ -32,20 +35,38 @@ namespace transport
 class USBTransport: public Transport
 {
 public:
-    USBTransport(boost::asio::io_service& ioService, usb::IAOAPDevice::Pointer aoapDevice);
+    USBTransport(boost::asio::io_service& ioService, usb::IAOAPDevice::Pointer aoapDevice, size_t receiveBufferLimit = common::cStaticDataSize);
+    // Bulk transfers are made from device memory of the AOAP device, falling back to heap memory where it cannot be allocated.
+    // Device memory is a scarce kernel resource, so the receive buffer has a fixed size.
+    USBTransport(boost::asio::io_service& ioService, usb::IAOAPDevice::Pointer aoapDevice, usb::IUSBWrapper& usbWrapper, size_t receiveBufferSize = cDeviceReceiveBufferSize);
 
     void stop() override;
 
+    // Number of bulk IN transfers kept outstanding while data is awaited, completed in submission order.
+    void setReceiveQueueDepth(size_t depth);
+    // Number of bulk OUT transfers submitted ahead of completion. They complete in submission order,
+    // a short transfer that is followed by others already in flight fails with USB_INCOMPLETE_TRANSFER.
+    void setSendQueueDepth(size_t depth);
+
 private:
     void enqueueReceive(common::DataBuffer buffer) override;
     void enqueueSend(SendQueue::iterator queueElement) override;
-    void doSend(SendQueue::iterator queueElement, common::Data::size_type offset);
-    void sendHandler(SendQueue::iterator queueElement, common::Data::size_type offset, size_t bytesTransferred);
+    void doSend(SendQueue::iterator queueElement, usb::USBDeviceMemory::Pointer sendBuffer, common::Data::size_type offset);
+    void sendHandler(SendQueue::iterator queueElement, usb::USBDeviceMemory::Pointer sendBuffer, common::Data::size_type offset, size_t bytesTransferred);
+    void finishSend(SendQueue::iterator queueElement, usb::USBDeviceMemory::Pointer sendBuffer);
+    usb::USBDeviceMemory::Pointer acquireSendBuffer(common::Data::size_type size);
+
+    static IDataSinkStorage::Pointer createReceiveStorage(usb::IUSBWrapper& usbWrapper, usb::DeviceHandle handle, size_t size);
 
     usb::IAOAPDevice::Pointer aoapDevice_;
+    usb::IUSBWrapper* usbWrapper_;
+    std::vector<usb::USBDeviceMemory::Pointer> sendBuffers_;
 
     static constexpr uint32_t cSendTimeoutMs = 10000;
     static constexpr uint32_t cReceiveTimeoutMs = 0;
+    static constexpr size_t cDeviceReceiveBufferSize = 1024 * 1024;
+    static constexpr size_t cDeviceReceiveMirrorSize = 64 * 1024;
+    static constexpr size_t cDeviceSendBufferSize = 32 * 1024;
 };
 
 }
@@ -76,6 +76,10 @@ public:
     virtual HotplugCallbackHandle hotplugRegisterCallback(libusb_hotplug_event events, libusb_hotplug_flag flags, int vendor_id, int product_id, int dev_class,
                                                           libusb_hotplug_callback_fn cb_fn, void *user_data) = 0;
     virtual libusb_transfer* allocTransfer(int iso_packets) = 0;
+    // Memory mapped by the kernel for transfers of this device, so they can skip the copy between user and kernel space.
+    // Returns nullptr when the platform or the libusb backend does not support it.
+    virtual unsigned char* devMemAlloc(const DeviceHandle& dev_handle, size_t length) = 0;
+    virtual int devMemFree(const DeviceHandle& dev_handle, unsigned char *buffer, size_t length) = 0;
 };
 
 }
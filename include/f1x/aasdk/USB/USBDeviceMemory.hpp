@@ -0,0 +1,54 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <f1x/aasdk/Common/Data.hpp>
+#include <f1x/aasdk/USB/IUSBWrapper.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace usb
+{
+
+// Transfer memory mapped by the kernel for the given device. Transfers made from it skip the copy into kernel buffers.
+class USBDeviceMemory: boost::noncopyable
+{
+public:
+    typedef std::shared_ptr<USBDeviceMemory> Pointer;
+
+    USBDeviceMemory(IUSBWrapper& usbWrapper, DeviceHandle handle, common::Data::size_type size);
+    ~USBDeviceMemory();
+
+    common::Data::value_type* getData();
+    common::Data::size_type getSize() const;
+
+private:
+    IUSBWrapper& usbWrapper_;
+    DeviceHandle handle_;
+    common::Data::value_type* data_;
+    common::Data::size_type size_;
+};
+
+}
+}
+}
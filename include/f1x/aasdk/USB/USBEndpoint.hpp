@@ -18,9 +18,10 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <deque>
 #include <memory>
 #include <boost/asio.hpp>
+#include <boost/intrusive/list.hpp>
 #include <f1x/aasdk/USB/IUSBWrapper.hpp>
 #include <f1x/aasdk/USB/IUSBEndpoint.hpp>
 
@@ -37,6 +38,7 @@ class USBEndpoint: public IUSBEndpoint,
 {
 public:
     USBEndpoint(IUSBWrapper& usbWrapper, boost::asio::io_service& ioService, DeviceHandle handle, uint8_t endpointAddress = 0x00);
+    ~USBEndpoint() override;
 
     void controlTransfer(common::DataBuffer buffer, uint32_t timeout, Promise::Pointer promise) override;
     void bulkTransfer(common::DataBuffer buffer, uint32_t timeout, Promise::Pointer promise) override;
@@ -46,17 +48,38 @@ public:
     DeviceHandle getDeviceHandle() const override;
 
 private:
-    typedef std::unordered_map<libusb_transfer*, Promise::Pointer> Transfers;
+    enum class TransferType
+    {
+        CONTROL,
+        BULK,
+        INTERRUPT
+    };
+
+    // libusb transfers are allocated on first use and reused for the lifetime of the endpoint
+    struct Transfer: boost::intrusive::list_base_hook<>
+    {
+        Transfer(USBEndpoint& endpoint, libusb_transfer* handle);
+
+        USBEndpoint& endpoint;
+        libusb_transfer* handle;
+        Promise::Pointer promise;
+    };
+
+    typedef boost::intrusive::list<Transfer> TransferList;
 
     using std::enable_shared_from_this<USBEndpoint>::shared_from_this;
-    void transfer(libusb_transfer *transfer, Promise::Pointer promise);
+    void transfer(TransferType type, common::DataBuffer buffer, uint32_t timeout, Promise::Pointer promise);
+    Transfer* acquireTransfer();
+    void fillTransfer(Transfer& transfer, TransferType type, common::DataBuffer buffer, uint32_t timeout);
     static void transferHandler(libusb_transfer *transfer);
 
     IUSBWrapper& usbWrapper_;
     boost::asio::io_service::strand strand_;
     DeviceHandle handle_;
     uint8_t endpointAddress_;
-    Transfers transfers_;
+    std::deque<Transfer> transfers_;
+    TransferList idleTransfers_;
+    TransferList pendingTransfers_;
     std::shared_ptr<USBEndpoint> self_;
 };
 
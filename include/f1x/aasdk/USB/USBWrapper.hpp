@@ -67,6 +67,8 @@ public:
     HotplugCallbackHandle hotplugRegisterCallback(libusb_hotplug_event events, libusb_hotplug_flag flags, int vendor_id, int product_id, int dev_class,
                                                   libusb_hotplug_callback_fn cb_fn, void *user_data) override;
     libusb_transfer* allocTransfer(int iso_packets) override;
+    unsigned char* devMemAlloc(const DeviceHandle& dev_handle, size_t length) override;
+    int devMemFree(const DeviceHandle& dev_handle, unsigned char *buffer, size_t length) override;
 
 private:
     libusb_context* usbContext_;
@@ -37,7 +37,9 @@ public:
     MOCK_METHOD0(deinit, void());
     MOCK_METHOD0(doHandshake, bool());
     MOCK_METHOD2(encrypt, size_t(common::Data& output, const common::DataConstBuffer& buffer));
+    MOCK_METHOD2(encryptBatch, std::vector<size_t>(std::vector<common::Data>& outputs, const std::vector<common::DataConstBuffer>& buffers));
     MOCK_METHOD2(decrypt, size_t(common::Data& output, const common::DataConstBuffer& buffer));
+    MOCK_METHOD2(decryptInto, size_t(common::DataBuffer output, const common::DataConstBuffer& buffer));
     MOCK_METHOD0(readHandshakeBuffer, common::Data());
     MOCK_METHOD1(writeHandshakeBuffer, void(const common::DataConstBuffer& buffer));
     MOCK_CONST_METHOD0(isActive, bool());
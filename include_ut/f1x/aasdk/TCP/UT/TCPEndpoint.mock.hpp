@@ -33,7 +33,7 @@ namespace ut
 class TCPEndpointMock: public ITCPEndpoint
 {
 public:
-    MOCK_METHOD2(send, void(common::DataConstBuffer buffer, Promise::Pointer promise));
+    MOCK_METHOD2(send, void(common::DataConstBufferSequence buffers, Promise::Pointer promise));
     MOCK_METHOD2(receive, void(common::DataBuffer buffer, Promise::Pointer promise));
     MOCK_METHOD0(stop, void());
 };
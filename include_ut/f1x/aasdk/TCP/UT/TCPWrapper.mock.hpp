@@ -33,7 +33,7 @@ namespace ut
 class TCPWrapperMock: public ITCPWrapper
 {
 public:
-    MOCK_METHOD3(asyncWrite, void(boost::asio::ip::tcp::socket& socket, common::DataConstBuffer buffer, Handler handler));
+    MOCK_METHOD3(asyncWrite, void(boost::asio::ip::tcp::socket& socket, common::DataConstBufferSequence buffers, Handler handler));
     MOCK_METHOD3(asyncRead, void(boost::asio::ip::tcp::socket& socket, common::DataBuffer buffer, Handler handler));
     MOCK_METHOD1(close, void(boost::asio::ip::tcp::socket& socket));
     MOCK_METHOD4(asyncConnect, void(boost::asio::ip::tcp::socket& socket, const std::string& hostname, uint16_t port, ConnectHandler handler));
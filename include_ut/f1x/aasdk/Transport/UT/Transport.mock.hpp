@@ -34,7 +34,8 @@ class TransportMock: public ITransport
 {
 public:
     MOCK_METHOD2(receive, void(size_t size, ReceivePromise::Pointer promise));
-    MOCK_METHOD2(send, void(common::Data data, SendPromise::Pointer promise));
+    MOCK_METHOD1(receiveAvailable, void(ReceivePromise::Pointer promise));
+    MOCK_METHOD2(send, void(common::DataSequence data, SendPromise::Pointer promise));
     MOCK_METHOD0(stop, void());
 };
 
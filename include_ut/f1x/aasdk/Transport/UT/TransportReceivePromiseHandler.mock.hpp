@@ -34,7 +34,7 @@ namespace ut
 class TransportReceivePromiseHandlerMock
 {
 public:
-    MOCK_METHOD1(onResolve, void(common::Data));
+    MOCK_METHOD1(onResolve, void(common::DataSlice));
     MOCK_METHOD1(onReject, void(const error::Error& e));
 };
 
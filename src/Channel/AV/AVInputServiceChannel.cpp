@@ -22,6 +22,7 @@
 #include <f1x/aasdk/Channel/AV/IAVInputServiceChannelEventHandler.hpp>
 #include <f1x/aasdk/Channel/AV/AVInputServiceChannel.hpp>
 #include <f1x/aasdk/Common/Log.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
 
 namespace f1x
 {
@@ -49,7 +50,7 @@ void AVInputServiceChannel::receive(IAVInputServiceChannelEventHandler::Pointer
 
 void AVInputServiceChannel::sendChannelOpenResponse(const proto::messages::ChannelOpenResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::CHANNEL_OPEN_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -58,7 +59,7 @@ void AVInputServiceChannel::sendChannelOpenResponse(const proto::messages::Chann
 
 void AVInputServiceChannel::sendAVChannelSetupResponse(const proto::messages::AVChannelSetupResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::SETUP_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -98,7 +99,7 @@ void AVInputServiceChannel::messageHandler(messenger::Message::Pointer message,
 
 void AVInputServiceChannel::sendAVInputOpenResponse(const proto::messages::AVInputOpenResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::AV_INPUT_OPEN_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -107,7 +108,7 @@ void AVInputServiceChannel::sendAVInputOpenResponse(const proto::messages::AVInp
 
 void AVInputServiceChannel::sendAVMediaWithTimestampIndication(messenger::Timestamp::ValueType timestamp, const common::Data& data, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::AV_MEDIA_WITH_TIMESTAMP_INDICATION).getData());
 
     auto timestampData = messenger::Timestamp(timestamp).getData();
@@ -21,6 +21,7 @@
 #include <f1x/aasdk/Channel/AV/IAudioServiceChannelEventHandler.hpp>
 #include <f1x/aasdk/Channel/AV/AudioServiceChannel.hpp>
 #include <f1x/aasdk/Common/Log.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
 
 namespace f1x
 {
@@ -53,7 +54,7 @@ messenger::ChannelId AudioServiceChannel::getId() const
 
 void AudioServiceChannel::sendChannelOpenResponse(const proto::messages::ChannelOpenResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::CHANNEL_OPEN_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -62,7 +63,7 @@ void AudioServiceChannel::sendChannelOpenResponse(const proto::messages::Channel
 
 void AudioServiceChannel::sendAVChannelSetupResponse(const proto::messages::AVChannelSetupResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::SETUP_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -71,7 +72,7 @@ void AudioServiceChannel::sendAVChannelSetupResponse(const proto::messages::AVCh
 
 void AudioServiceChannel::sendAVMediaAckIndication(const proto::messages::AVMediaAckIndication& indication, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::AV_MEDIA_ACK_INDICATION).getData());
     message->insertPayload(indication);
 
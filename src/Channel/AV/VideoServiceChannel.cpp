@@ -22,6 +22,7 @@
 #include <f1x/aasdk/Channel/AV/IVideoServiceChannelEventHandler.hpp>
 #include <f1x/aasdk/Channel/AV/VideoServiceChannel.hpp>
 #include <f1x/aasdk/Common/Log.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
 
 namespace f1x
 {
@@ -54,7 +55,7 @@ messenger::ChannelId VideoServiceChannel::getId() const
 
 void VideoServiceChannel::sendChannelOpenResponse(const proto::messages::ChannelOpenResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::CHANNEL_OPEN_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -63,7 +64,7 @@ void VideoServiceChannel::sendChannelOpenResponse(const proto::messages::Channel
 
 void VideoServiceChannel::sendAVChannelSetupResponse(const proto::messages::AVChannelSetupResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::SETUP_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -72,7 +73,7 @@ void VideoServiceChannel::sendAVChannelSetupResponse(const proto::messages::AVCh
 
 void VideoServiceChannel::sendVideoFocusIndication(const proto::messages::VideoFocusIndication& indication, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::VIDEO_FOCUS_INDICATION).getData());
     message->insertPayload(indication);
 
@@ -81,7 +82,7 @@ void VideoServiceChannel::sendVideoFocusIndication(const proto::messages::VideoF
 
 void VideoServiceChannel::sendAVMediaAckIndication(const proto::messages::AVMediaAckIndication& indication, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::AVChannelMessage::AV_MEDIA_ACK_INDICATION).getData());
     message->insertPayload(indication);
 
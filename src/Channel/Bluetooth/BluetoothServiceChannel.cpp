@@ -22,6 +22,7 @@
 #include <f1x/aasdk/Channel/Bluetooth/IBluetoothServiceChannelEventHandler.hpp>
 #include <f1x/aasdk/Channel/Bluetooth/BluetoothServiceChannel.hpp>
 #include <f1x/aasdk/Common/Log.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
 
 namespace f1x
 {
@@ -54,7 +55,7 @@ messenger::ChannelId BluetoothServiceChannel::getId() const
 
 void BluetoothServiceChannel::sendChannelOpenResponse(const proto::messages::ChannelOpenResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::CONTROL));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::CHANNEL_OPEN_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -63,7 +64,7 @@ void BluetoothServiceChannel::sendChannelOpenResponse(const proto::messages::Cha
 
 void BluetoothServiceChannel::sendBluetoothPairingResponse(const proto::messages::BluetoothPairingResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::BluetoothChannelMessage::PAIRING_RESPONSE).getData());
     message->insertPayload(response);
 
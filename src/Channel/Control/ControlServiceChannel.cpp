@@ -23,6 +23,7 @@
 #include <f1x/aasdk/Channel/Control/ControlServiceChannel.hpp>
 #include <f1x/aasdk/Channel/Control/IControlServiceChannelEventHandler.hpp>
 #include <f1x/aasdk/Common/Log.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
 
 namespace f1x
 {
@@ -41,7 +42,7 @@ ControlServiceChannel::ControlServiceChannel(boost::asio::io_service::strand& st
 
 void ControlServiceChannel::sendVersionRequest(SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::VERSION_REQUEST).getData());
 
     common::Data versionBuffer(4, 0);
@@ -54,7 +55,7 @@ void ControlServiceChannel::sendVersionRequest(SendPromise::Pointer promise)
 
 void ControlServiceChannel::sendHandshake(common::Data handshakeBuffer, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::SSL_HANDSHAKE).getData());
     message->insertPayload(handshakeBuffer);
 
@@ -63,7 +64,7 @@ void ControlServiceChannel::sendHandshake(common::Data handshakeBuffer, SendProm
 
 void ControlServiceChannel::sendAuthComplete(const proto::messages::AuthCompleteIndication& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::AUTH_COMPLETE).getData());
     message->insertPayload(response);
 
@@ -72,7 +73,7 @@ void ControlServiceChannel::sendAuthComplete(const proto::messages::AuthComplete
 
 void ControlServiceChannel::sendServiceDiscoveryResponse(const proto::messages::ServiceDiscoveryResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::SERVICE_DISCOVERY_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -81,7 +82,7 @@ void ControlServiceChannel::sendServiceDiscoveryResponse(const proto::messages::
 
 void ControlServiceChannel::sendAudioFocusResponse(const proto::messages::AudioFocusResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::AUDIO_FOCUS_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -90,7 +91,7 @@ void ControlServiceChannel::sendAudioFocusResponse(const proto::messages::AudioF
 
 void ControlServiceChannel::sendShutdownRequest(const proto::messages::ShutdownRequest& request, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::SHUTDOWN_REQUEST).getData());
     message->insertPayload(request);
 
@@ -99,7 +100,7 @@ void ControlServiceChannel::sendShutdownRequest(const proto::messages::ShutdownR
 
 void ControlServiceChannel::sendShutdownResponse(const proto::messages::ShutdownResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::SHUTDOWN_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -108,7 +109,7 @@ void ControlServiceChannel::sendShutdownResponse(const proto::messages::Shutdown
 
 void ControlServiceChannel::sendNavigationFocusResponse(const proto::messages::NavigationFocusResponse& response, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::ENCRYPTED, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::NAVIGATION_FOCUS_RESPONSE).getData());
     message->insertPayload(response);
 
@@ -117,7 +118,7 @@ void ControlServiceChannel::sendNavigationFocusResponse(const proto::messages::N
 
 void ControlServiceChannel::sendPingRequest(const proto::messages::PingRequest& request, SendPromise::Pointer promise)
 {
-    auto message(std::make_shared<messenger::Message>(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
+    auto message(messenger::MessagePool::create(channelId_, messenger::EncryptionType::PLAIN, messenger::MessageType::SPECIFIC));
     message->insertPayload(messenger::MessageId(proto::ids::ControlMessage::PING_REQUEST).getData());
     message->insertPayload(request);
 
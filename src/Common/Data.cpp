@@ -16,6 +16,8 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cstring>
 #include <boost/algorithm/hex.hpp>
 #include <f1x/aasdk/Common/Data.hpp>
 #include <f1x/aasdk/Common/Log.hpp>
@@ -109,6 +111,12 @@ DataConstBuffer::DataConstBuffer(const Data& _data, Data::size_type offset)
 
 }
 
+DataConstBuffer::DataConstBuffer(const DataSlice& slice)
+    : cdata(slice.cdata)
+    , size(slice.size)
+{
+}
+
 bool DataConstBuffer::operator==(const std::nullptr_t&) const
 {
     return cdata == nullptr || size == 0;
@@ -119,6 +127,78 @@ bool DataConstBuffer::operator==(const DataConstBuffer& buffer) const
     return cdata == buffer.cdata && size == buffer.size;
 }
 
+DataSlice::DataSlice()
+    : cdata(nullptr)
+    , size(0)
+{
+
+}
+
+DataSlice::DataSlice(Data _data)
+    : DataSlice()
+{
+    if(!_data.empty())
+    {
+        auto storage = std::allocate_shared<Data>(DataAllocator<Data>(), std::move(_data));
+        cdata = &(*storage)[0];
+        size = storage->size();
+        owner = std::move(storage);
+    }
+}
+
+DataSlice::DataSlice(std::shared_ptr<const void> _owner, const DataConstBuffer& buffer)
+    : owner(buffer.size == 0 ? nullptr : std::move(_owner))
+    , cdata(buffer.cdata)
+    , size(buffer.size)
+{
+
+}
+
+bool DataSlice::operator==(const std::nullptr_t&) const
+{
+    return cdata == nullptr || size == 0;
+}
+
+bool DataSlice::operator==(const Data& _data) const
+{
+    return size == _data.size() && (size == 0 || memcmp(cdata, &_data[0], size) == 0);
+}
+
+DataSequence::DataSequence()
+{
+
+}
+
+DataSequence::DataSequence(Data _head)
+    : head(std::move(_head))
+{
+
+}
+
+DataSequence::DataSequence(Data _head, DataSlice _payload)
+    : head(std::move(_head))
+    , payload(std::move(_payload))
+{
+
+}
+
+Data::size_type DataSequence::size() const
+{
+    return head.size() + payload.size;
+}
+
+bool DataSequence::operator==(const Data& _data) const
+{
+    return this->size() == _data.size()
+            && std::equal(head.begin(), head.end(), _data.begin())
+            && (payload.size == 0 || memcmp(payload.cdata, &_data[head.size()], payload.size) == 0);
+}
+
+DataConstBufferSequence createBufferSequence(const DataSequence& sequence)
+{
+    return {{DataConstBuffer(sequence.head), DataConstBuffer(sequence.payload)}};
+}
+
 common::Data createData(const DataConstBuffer& buffer)
 {
     common::Data data;
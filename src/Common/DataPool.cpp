@@ -0,0 +1,167 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <array>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <f1x/aasdk/Common/DataPool.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace common
+{
+
+namespace
+{
+
+class SizeClass
+{
+public:
+    SizeClass(size_t blockSize, size_t maxFreeBlocksCount)
+        : blockSize_(blockSize)
+        , maxFreeBlocksCount_(maxFreeBlocksCount)
+    {
+        freeBlocks_.reserve(maxFreeBlocksCount_);
+    }
+
+    size_t getBlockSize() const
+    {
+        return blockSize_;
+    }
+
+    void* pop()
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        if(freeBlocks_.empty())
+        {
+            return nullptr;
+        }
+
+        auto block = freeBlocks_.back();
+        freeBlocks_.pop_back();
+        return block;
+    }
+
+    bool push(void* block)
+    {
+        std::lock_guard<decltype(mutex_)> lock(mutex_);
+
+        if(freeBlocks_.size() >= maxFreeBlocksCount_)
+        {
+            return false;
+        }
+
+        freeBlocks_.push_back(block);
+        return true;
+    }
+
+private:
+    size_t blockSize_;
+    size_t maxFreeBlocksCount_;
+    std::mutex mutex_;
+    std::vector<void*> freeBlocks_;
+};
+
+// 16384 bytes of frame payload, 2 bytes of frame header and up to 6 bytes of frame size
+static constexpr size_t cFrameBlockSize = 16384 + 2 + 6;
+
+std::array<SizeClass, 4>& getSizeClasses()
+{
+    // never destroyed, buffers may still be released by other static objects at exit
+    static auto sizeClasses = new std::array<SizeClass, 4>{{
+        {8, 1024},
+        {64, 1024},
+        {512, 256},
+        {cFrameBlockSize, 64}
+    }};
+
+    return *sizeClasses;
+}
+
+SizeClass* findSizeClass(size_t size)
+{
+    for(auto& sizeClass : getSizeClasses())
+    {
+        if(size <= sizeClass.getBlockSize())
+        {
+            return &sizeClass;
+        }
+    }
+
+    return nullptr;
+}
+
+}
+
+std::atomic<uint64_t> DataPool::poolAllocations_(0);
+std::atomic<uint64_t> DataPool::heapAllocations_(0);
+std::atomic<uint64_t> DataPool::deallocations_(0);
+
+void* DataPool::allocate(size_t size)
+{
+    auto sizeClass = findSizeClass(size);
+
+    if(sizeClass != nullptr)
+    {
+        auto block = sizeClass->pop();
+
+        if(block != nullptr)
+        {
+            poolAllocations_.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+
+        size = sizeClass->getBlockSize();
+    }
+
+    heapAllocations_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void DataPool::deallocate(void* pointer, size_t size)
+{
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    auto sizeClass = findSizeClass(size);
+
+    if(sizeClass == nullptr || !sizeClass->push(pointer))
+    {
+        ::operator delete(pointer);
+    }
+}
+
+DataPool::Statistics DataPool::getStatistics()
+{
+    return {poolAllocations_.load(std::memory_order_relaxed),
+            heapAllocations_.load(std::memory_order_relaxed),
+            deallocations_.load(std::memory_order_relaxed)};
+}
+
+void DataPool::resetStatistics()
+{
+    poolAllocations_.store(0, std::memory_order_relaxed);
+    heapAllocations_.store(0, std::memory_order_relaxed);
+    deallocations_.store(0, std::memory_order_relaxed);
+}
+
+}
+}
+}
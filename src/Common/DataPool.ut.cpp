@@ -0,0 +1,71 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/Common/Data.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace common
+{
+namespace ut
+{
+
+void createFrame()
+{
+    Data frameHeader(2, 0x5E);
+    Data frameSize(6, 0x5F);
+    DataSlice payload(Data(16384, 0x60));
+}
+
+BOOST_AUTO_TEST_CASE(DataPool_SteadyStateFramesDoNotAllocateFromHeap)
+{
+    createFrame();
+    DataPool::resetStatistics();
+
+    for(size_t i = 0; i < 100; ++i)
+    {
+        createFrame();
+    }
+
+    const auto statistics = DataPool::getStatistics();
+    BOOST_TEST(statistics.heapAllocations == 0u);
+    BOOST_TEST(statistics.poolAllocations == 400u);
+    BOOST_TEST(statistics.deallocations == 400u);
+}
+
+BOOST_AUTO_TEST_CASE(DataPool_OversizedDataIsAllocatedFromHeap)
+{
+    DataPool::resetStatistics();
+
+    {
+        Data data(1024 * 1024, 0x5E);
+    }
+
+    const auto statistics = DataPool::getStatistics();
+    BOOST_TEST(statistics.heapAllocations == 1u);
+    BOOST_TEST(statistics.poolAllocations == 0u);
+    BOOST_TEST(statistics.deallocations == 1u);
+}
+
+}
+}
+}
+}
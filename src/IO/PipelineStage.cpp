@@ -0,0 +1,113 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <algorithm>
+#include <pthread.h>
+#include <time.h>
+#include <f1x/aasdk/IO/PipelineStage.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace io
+{
+
+PipelineStage::PipelineStage()
+    : work_(ioService_)
+    , queueDepth_(0)
+    , maxQueueDepth_(0)
+    , processedJobsCount_(0)
+    , busyTimeOrigin_(0)
+    , elapsedTimeOrigin_(std::chrono::steady_clock::now())
+    , thread_([this]() { ioService_.run(); })
+{
+    threadHandle_ = thread_.native_handle();
+}
+
+PipelineStage::~PipelineStage()
+{
+    // jobs still queued are dropped
+    ioService_.stop();
+    thread_.join();
+}
+
+boost::asio::io_service& PipelineStage::getIOService()
+{
+    return ioService_;
+}
+
+void PipelineStage::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(statisticsMutex_);
+        ++queueDepth_;
+        maxQueueDepth_ = std::max(maxQueueDepth_, queueDepth_);
+    }
+
+    ioService_.post([this, job = std::move(job)]() mutable {
+        job();
+
+        std::lock_guard<std::mutex> lock(statisticsMutex_);
+        --queueDepth_;
+        ++processedJobsCount_;
+    });
+}
+
+PipelineStage::Statistics PipelineStage::getStatistics() const
+{
+    const auto busyTime = this->getThreadCPUTime();
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    const auto elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - elapsedTimeOrigin_);
+    Statistics statistics{queueDepth_, maxQueueDepth_, processedJobsCount_, busyTime - busyTimeOrigin_, elapsedTime, 0.0};
+
+    if(statistics.elapsedTime.count() > 0)
+    {
+        statistics.utilization = std::min(1.0, static_cast<double>(statistics.busyTime.count()) / statistics.elapsedTime.count());
+    }
+
+    return statistics;
+}
+
+void PipelineStage::resetStatistics()
+{
+    const auto busyTime = this->getThreadCPUTime();
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    maxQueueDepth_ = queueDepth_;
+    processedJobsCount_ = 0;
+    busyTimeOrigin_ = busyTime;
+    elapsedTimeOrigin_ = std::chrono::steady_clock::now();
+}
+
+std::chrono::microseconds PipelineStage::getThreadCPUTime() const
+{
+    clockid_t clockId;
+    timespec time;
+
+    if(pthread_getcpuclockid(threadHandle_, &clockId) != 0 || clock_gettime(clockId, &time) != 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec));
+}
+
+}
+}
+}
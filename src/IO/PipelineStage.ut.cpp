@@ -0,0 +1,115 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <future>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/IO/PipelineStage.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace io
+{
+namespace ut
+{
+
+BOOST_AUTO_TEST_CASE(PipelineStage_JobsRunInOrderOnStageThread)
+{
+    PipelineStage pipelineStage;
+    std::vector<size_t> order;
+    std::vector<std::thread::id> threadIds;
+    std::promise<void> done;
+
+    for(size_t i = 0; i < 100; ++i)
+    {
+        pipelineStage.post([&, i]() {
+            order.push_back(i);
+            threadIds.push_back(std::this_thread::get_id());
+
+            if(i == 99)
+            {
+                done.set_value();
+            }
+        });
+    }
+
+    done.get_future().wait();
+
+    BOOST_TEST(order.size() == 100u);
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        BOOST_TEST(order[i] == i);
+        BOOST_TEST((threadIds[i] != std::this_thread::get_id()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PipelineStage_Statistics)
+{
+    PipelineStage pipelineStage;
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> done;
+
+    pipelineStage.post([&]() {
+        started.set_value();
+        released.wait();
+    });
+    pipelineStage.post([]() {});
+    pipelineStage.post([&]() {
+        // keep the stage thread busy for a while
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+        while(std::chrono::steady_clock::now() < end);
+        done.set_value();
+    });
+
+    started.get_future().wait();
+    auto statistics = pipelineStage.getStatistics();
+    BOOST_TEST(statistics.queueDepth == 3u);
+    BOOST_TEST(statistics.maxQueueDepth == 3u);
+    BOOST_TEST(statistics.processedJobsCount == 0u);
+
+    release.set_value();
+    done.get_future().wait();
+
+    // the last job is counted after it returns
+    do
+    {
+        statistics = pipelineStage.getStatistics();
+    }
+    while(statistics.processedJobsCount < 3);
+
+    BOOST_TEST(statistics.queueDepth == 0u);
+    BOOST_TEST(statistics.maxQueueDepth == 3u);
+    BOOST_TEST(statistics.busyTime.count() > 0);
+    BOOST_TEST(statistics.busyTime.count() <= statistics.elapsedTime.count());
+    BOOST_TEST(statistics.utilization > 0.0);
+    BOOST_TEST(statistics.utilization <= 1.0);
+
+    pipelineStage.resetStatistics();
+    statistics = pipelineStage.getStatistics();
+    BOOST_TEST(statistics.maxQueueDepth == 0u);
+    BOOST_TEST(statistics.processedJobsCount == 0u);
+    BOOST_TEST(statistics.busyTime.count() < 20000);
+}
+
+}
+}
+}
+}
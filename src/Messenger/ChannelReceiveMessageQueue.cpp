@@ -16,6 +16,10 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <limits>
+#include <aasdk_proto/AVChannelMessageIdsEnum.pb.h>
+#include <f1x/aasdk/Messenger/MessageId.hpp>
 #include <f1x/aasdk/Messenger/ChannelReceiveMessageQueue.hpp>
 
 namespace f1x
@@ -25,41 +29,208 @@ namespace aasdk
 namespace messenger
 {
 
+ChannelReceiveMessageQueue::Channel::Channel()
+    : policy(ReceiveQueuePolicy::UNBOUNDED)
+    , limit(std::numeric_limits<size_t>::max())
+    , waitingForKeyFrame(false)
+    , statistics{0, 0, 0, 0}
+{
+
+}
+
+void ChannelReceiveMessageQueue::setPolicy(ChannelId channelId, ReceiveQueuePolicy policy, size_t limit)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& channel = channels_[channelId];
+    channel.policy = policy;
+    channel.limit = std::max<size_t>(limit, 1);
+    channel.waitingForKeyFrame = false;
+}
+
 void ChannelReceiveMessageQueue::push(Message::Pointer message)
 {
-    const auto channelId = message->getChannelId();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto& channel = channels_[message->getChannelId()];
 
-    if(queue_.count(channelId) == 0)
+    switch(channel.policy)
     {
-        queue_.emplace(std::make_pair(channelId, MessageQueue()));
+    case ReceiveQueuePolicy::UNBOUNDED:
+        channel.queue.push_back(std::move(message));
+        break;
+
+    case ReceiveQueuePolicy::BLOCK:
+        channel.queue.push_back(std::move(message));
+        if(channel.queue.size() == channel.limit)
+        {
+            ++channel.statistics.blockedCount;
+        }
+        break;
+
+    case ReceiveQueuePolicy::DROP_OLDEST:
+        if(channel.queue.size() >= channel.limit)
+        {
+            channel.queue.pop_front();
+            ++channel.statistics.droppedMessagesCount;
+        }
+        channel.queue.push_back(std::move(message));
+        break;
+
+    case ReceiveQueuePolicy::DROP_UNTIL_KEY_FRAME:
+        this->dropUntilKeyFrame(channel, std::move(message));
+        break;
     }
 
-    auto& channelQueue = queue_.at(channelId);
-    channelQueue.emplace(std::move(message));
+    channel.statistics.queueDepth = channel.queue.size();
+    channel.statistics.maxQueueDepth = std::max(channel.statistics.maxQueueDepth, channel.statistics.queueDepth);
 }
 
 Message::Pointer ChannelReceiveMessageQueue::pop(ChannelId channelId)
 {
-    auto& channelQueue = queue_.at(channelId);
-    auto message(std::move(channelQueue.front()));
-    channelQueue.pop();
+    std::lock_guard<std::mutex> lock(mutex_);
 
-    if(channelQueue.empty())
-    {
-        queue_.erase(channelId);
-    }
+    auto& channel = channels_.at(channelId);
+    auto message(std::move(channel.queue.front()));
+    channel.queue.pop_front();
+    channel.statistics.queueDepth = channel.queue.size();
 
     return message;
 }
 
 bool ChannelReceiveMessageQueue::empty(ChannelId channelId) const
 {
-    return queue_.count(channelId) == 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto channel = channels_.find(channelId);
+    return channel == channels_.end() || channel->second.queue.empty();
+}
+
+bool ChannelReceiveMessageQueue::blocked() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return std::any_of(channels_.begin(), channels_.end(), [](const auto& channel) {
+        return channel.second.policy == ReceiveQueuePolicy::BLOCK && channel.second.queue.size() >= channel.second.limit;
+    });
 }
 
 void ChannelReceiveMessageQueue::clear()
 {
-    queue_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for(auto& channel : channels_)
+    {
+        channel.second.queue.clear();
+        channel.second.waitingForKeyFrame = false;
+        channel.second.statistics.queueDepth = 0;
+    }
+}
+
+ChannelReceiveMessageQueue::Statistics ChannelReceiveMessageQueue::getStatistics(ChannelId channelId) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto channel = channels_.find(channelId);
+    return channel != channels_.end() ? channel->second.statistics : Statistics{0, 0, 0, 0};
+}
+
+void ChannelReceiveMessageQueue::dropUntilKeyFrame(Channel& channel, Message::Pointer message)
+{
+    if(channel.waitingForKeyFrame && isMedia(*message))
+    {
+        if(!isKeyFrame(*message))
+        {
+            ++channel.statistics.droppedMessagesCount;
+            return;
+        }
+
+        channel.waitingForKeyFrame = false;
+    }
+
+    channel.queue.push_back(std::move(message));
+
+    if(channel.queue.size() <= channel.limit)
+    {
+        return;
+    }
+
+    // the application does not keep up, skip straight to the most recent key frame
+    const auto keyFrame = std::find_if(channel.queue.rbegin(), channel.queue.rend(), [](const auto& queuedMessage) {
+        return isMedia(*queuedMessage) && isKeyFrame(*queuedMessage);
+    });
+
+    if(keyFrame != channel.queue.rend())
+    {
+        this->dropMedia(channel, std::prev(keyFrame.base()));
+    }
+
+    // nothing to skip to, wait for the next key frame
+    if(channel.queue.size() > channel.limit)
+    {
+        this->dropMedia(channel, channel.queue.end());
+        channel.waitingForKeyFrame = true;
+    }
+
+    // only control messages left, memory still has to stay bounded
+    while(channel.queue.size() > channel.limit)
+    {
+        channel.queue.pop_front();
+        ++channel.statistics.droppedMessagesCount;
+    }
+}
+
+void ChannelReceiveMessageQueue::dropMedia(Channel& channel, std::deque<Message::Pointer>::iterator end)
+{
+    const auto newEnd = std::remove_if(channel.queue.begin(), end, [](const auto& queuedMessage) { return isMedia(*queuedMessage); });
+    channel.statistics.droppedMessagesCount += std::distance(newEnd, end);
+    channel.queue.erase(newEnd, end);
+}
+
+bool ChannelReceiveMessageQueue::isMedia(const Message& message)
+{
+    const auto& payload = message.getPayload();
+
+    if(message.getType() != MessageType::SPECIFIC || payload.size() < MessageId::getSizeOf())
+    {
+        return false;
+    }
+
+    const MessageId messageId(payload);
+    return messageId == proto::ids::AVChannelMessage::AV_MEDIA_WITH_TIMESTAMP_INDICATION || messageId == proto::ids::AVChannelMessage::AV_MEDIA_INDICATION;
+}
+
+bool ChannelReceiveMessageQueue::isKeyFrame(const Message& message)
+{
+    const auto& payload = message.getPayload();
+    const MessageId messageId(payload);
+    const size_t offset = MessageId::getSizeOf() + (messageId == proto::ids::AVChannelMessage::AV_MEDIA_WITH_TIMESTAMP_INDICATION ? sizeof(uint64_t) : 0);
+
+    // H.264 access unit, look for IDR slice or SPS before the first regular slice
+    bool startCodeFound = false;
+
+    for(size_t i = offset; i + 3 < payload.size(); ++i)
+    {
+        if(payload[i] == 0 && payload[i + 1] == 0 && payload[i + 2] == 1)
+        {
+            const auto nalUnitType = payload[i + 3] & 0x1F;
+            startCodeFound = true;
+
+            if(nalUnitType == 5 || nalUnitType == 7)
+            {
+                return true;
+            }
+            else if(nalUnitType >= 1 && nalUnitType <= 4)
+            {
+                return false;
+            }
+
+            i += 2;
+        }
+    }
+
+    // not a video stream, audio frames can be decoded on their own
+    return !startCodeFound;
 }
 
 }
@@ -0,0 +1,148 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <aasdk_proto/AVChannelMessageIdsEnum.pb.h>
+#include <f1x/aasdk/Messenger/MessageId.hpp>
+#include <f1x/aasdk/Messenger/ChannelReceiveMessageQueue.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+namespace ut
+{
+
+Message::Pointer createMessage(ChannelId channelId, uint16_t messageId, const common::Data& payload = common::Data())
+{
+    auto message = std::make_shared<Message>(channelId, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    message->insertPayload(MessageId(messageId).getData());
+    message->insertPayload(payload);
+    return message;
+}
+
+Message::Pointer createVideoFrame(uint8_t nalUnitType)
+{
+    common::Data payload(sizeof(uint64_t), 0);
+    payload.insert(payload.end(), {0x00, 0x00, 0x00, 0x01, static_cast<uint8_t>(0x60 | nalUnitType), 0xAA, 0xBB});
+    return createMessage(ChannelId::VIDEO, proto::ids::AVChannelMessage::AV_MEDIA_WITH_TIMESTAMP_INDICATION, payload);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveMessageQueue_UnboundedByDefault)
+{
+    ChannelReceiveMessageQueue queue;
+
+    for(uint16_t i = 0; i < 2048; ++i)
+    {
+        queue.push(createVideoFrame(1));
+    }
+
+    BOOST_CHECK(!queue.blocked());
+
+    const auto statistics = queue.getStatistics(ChannelId::VIDEO);
+    BOOST_CHECK_EQUAL(statistics.queueDepth, 2048u);
+    BOOST_CHECK_EQUAL(statistics.droppedMessagesCount, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveMessageQueue_DropOldest)
+{
+    ChannelReceiveMessageQueue queue;
+    queue.setPolicy(ChannelId::INPUT, ReceiveQueuePolicy::DROP_OLDEST, 2);
+
+    const auto message1 = createMessage(ChannelId::INPUT, 1);
+    const auto message2 = createMessage(ChannelId::INPUT, 2);
+    const auto message3 = createMessage(ChannelId::INPUT, 3);
+    queue.push(message1);
+    queue.push(message2);
+    queue.push(message3);
+
+    BOOST_CHECK(queue.pop(ChannelId::INPUT) == message2);
+    BOOST_CHECK(queue.pop(ChannelId::INPUT) == message3);
+    BOOST_CHECK(queue.empty(ChannelId::INPUT));
+    BOOST_CHECK(!queue.blocked());
+
+    const auto statistics = queue.getStatistics(ChannelId::INPUT);
+    BOOST_CHECK_EQUAL(statistics.queueDepth, 0u);
+    BOOST_CHECK_EQUAL(statistics.maxQueueDepth, 2u);
+    BOOST_CHECK_EQUAL(statistics.droppedMessagesCount, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveMessageQueue_Block)
+{
+    ChannelReceiveMessageQueue queue;
+    queue.setPolicy(ChannelId::SENSOR, ReceiveQueuePolicy::BLOCK, 2);
+
+    queue.push(createMessage(ChannelId::SENSOR, 1));
+    BOOST_CHECK(!queue.blocked());
+    queue.push(createMessage(ChannelId::SENSOR, 2));
+    BOOST_CHECK(queue.blocked());
+
+    queue.pop(ChannelId::SENSOR);
+    BOOST_CHECK(!queue.blocked());
+
+    const auto statistics = queue.getStatistics(ChannelId::SENSOR);
+    BOOST_CHECK_EQUAL(statistics.queueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics.droppedMessagesCount, 0u);
+    BOOST_CHECK_EQUAL(statistics.blockedCount, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveMessageQueue_DropUntilKeyFrame)
+{
+    ChannelReceiveMessageQueue queue;
+    queue.setPolicy(ChannelId::VIDEO, ReceiveQueuePolicy::DROP_UNTIL_KEY_FRAME, 3);
+
+    const auto setupRequest = createMessage(ChannelId::VIDEO, proto::ids::AVChannelMessage::SETUP_REQUEST);
+    queue.push(setupRequest);
+    queue.push(createVideoFrame(5));
+    queue.push(createVideoFrame(1));
+    queue.push(createVideoFrame(1));
+
+    // no key frame after the stall, all queued media goes away and so does the media until the next key frame
+    BOOST_CHECK_EQUAL(queue.getStatistics(ChannelId::VIDEO).queueDepth, 1u);
+    BOOST_CHECK_EQUAL(queue.getStatistics(ChannelId::VIDEO).droppedMessagesCount, 3u);
+
+    queue.push(createVideoFrame(1));
+    const auto keyFrame = createVideoFrame(5);
+    queue.push(keyFrame);
+    const auto frame = createVideoFrame(1);
+    queue.push(frame);
+
+    BOOST_CHECK(queue.pop(ChannelId::VIDEO) == setupRequest);
+    BOOST_CHECK(queue.pop(ChannelId::VIDEO) == keyFrame);
+    BOOST_CHECK(queue.pop(ChannelId::VIDEO) == frame);
+    BOOST_CHECK(queue.empty(ChannelId::VIDEO));
+    BOOST_CHECK_EQUAL(queue.getStatistics(ChannelId::VIDEO).droppedMessagesCount, 4u);
+
+    // a queued key frame is kept, only the media before it is dropped
+    queue.push(createVideoFrame(1));
+    const auto queuedKeyFrame = createVideoFrame(7);
+    queue.push(queuedKeyFrame);
+    queue.push(createVideoFrame(1));
+    queue.push(createVideoFrame(1));
+
+    BOOST_CHECK(queue.pop(ChannelId::VIDEO) == queuedKeyFrame);
+    BOOST_CHECK_EQUAL(queue.getStatistics(ChannelId::VIDEO).queueDepth, 2u);
+    BOOST_CHECK_EQUAL(queue.getStatistics(ChannelId::VIDEO).droppedMessagesCount, 5u);
+}
+
+}
+}
+}
+}
@@ -0,0 +1,219 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/aasdk/Messenger/ChannelReceiveRing.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+namespace
+{
+
+size_t roundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+
+    while(result < value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+}
+
+ChannelReceiveRing::ChannelReceiveRing(size_t capacity)
+    : slots_(roundUpToPowerOfTwo(std::max<size_t>(capacity, 1)))
+    , mask_(slots_.size() - 1)
+    , head_(0)
+    , tail_(0)
+    , closed_(false)
+    , waiting_(false)
+    , spaceWanted_(false)
+    , droppedMessagesCount_(0)
+{
+
+}
+
+bool ChannelReceiveRing::push(Message::Pointer message)
+{
+    const auto tail = tail_.load(std::memory_order_relaxed);
+
+    if(tail - head_.load(std::memory_order_acquire) == slots_.size())
+    {
+        droppedMessagesCount_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    slots_[tail & mask_] = std::move(message);
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+    this->notify();
+
+    return true;
+}
+
+bool ChannelReceiveRing::full() const
+{
+    return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_seq_cst) == slots_.size();
+}
+
+void ChannelReceiveRing::notifyOnSpace(std::function<void()> handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spaceHandler_ = std::move(handler);
+        spaceWanted_.store(true, std::memory_order_seq_cst);
+    }
+
+    // the consumer may have popped between the producer's check and the registration
+    if(!this->full())
+    {
+        this->notifySpace();
+    }
+}
+
+void ChannelReceiveRing::close(const error::Error& e)
+{
+    if(!closed_.load(std::memory_order_relaxed))
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            spaceWanted_.store(false, std::memory_order_relaxed);
+            spaceHandler_ = nullptr;
+        }
+
+        error_ = e;
+        closed_.store(true, std::memory_order_seq_cst);
+        this->notify();
+    }
+}
+
+Message::Pointer ChannelReceiveRing::tryPop()
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+
+    if(head == tail_.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    auto message(std::move(slots_[head & mask_]));
+    head_.store(head + 1, std::memory_order_seq_cst);
+
+    if(spaceWanted_.load(std::memory_order_seq_cst))
+    {
+        this->notifySpace();
+    }
+
+    return message;
+}
+
+Message::Pointer ChannelReceiveRing::pop()
+{
+    auto message = this->tryPop();
+
+    if(message == nullptr && !this->ready())
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_.store(true, std::memory_order_seq_cst);
+        condition_.wait(lock, [this]() { return this->ready(); });
+        waiting_.store(false, std::memory_order_relaxed);
+    }
+
+    return message != nullptr ? message : this->tryPop();
+}
+
+Message::Pointer ChannelReceiveRing::pop(std::chrono::milliseconds timeout)
+{
+    auto message = this->tryPop();
+
+    if(message == nullptr && !this->ready())
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_.store(true, std::memory_order_seq_cst);
+        condition_.wait_for(lock, timeout, [this]() { return this->ready(); });
+        waiting_.store(false, std::memory_order_relaxed);
+    }
+
+    return message != nullptr ? message : this->tryPop();
+}
+
+bool ChannelReceiveRing::isClosed() const
+{
+    return closed_.load(std::memory_order_acquire);
+}
+
+error::Error ChannelReceiveRing::getError() const
+{
+    return this->isClosed() ? error_ : error::Error();
+}
+
+size_t ChannelReceiveRing::getCapacity() const
+{
+    return slots_.size();
+}
+
+uint64_t ChannelReceiveRing::getDroppedMessagesCount() const
+{
+    return droppedMessagesCount_.load(std::memory_order_relaxed);
+}
+
+bool ChannelReceiveRing::ready() const
+{
+    return head_.load(std::memory_order_relaxed) != tail_.load(std::memory_order_seq_cst) || closed_.load(std::memory_order_seq_cst);
+}
+
+void ChannelReceiveRing::notify()
+{
+    // the consumer announces itself before it checks the ring under the mutex, so taking the mutex here
+    // cannot slip between its check and its wait
+    if(waiting_.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_one();
+    }
+}
+
+void ChannelReceiveRing::notifySpace()
+{
+    std::function<void()> handler;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if(!spaceWanted_.exchange(false, std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        handler = std::move(spaceHandler_);
+        spaceHandler_ = nullptr;
+    }
+
+    handler();
+}
+
+}
+}
+}
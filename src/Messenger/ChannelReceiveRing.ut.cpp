@@ -0,0 +1,132 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/Messenger/ChannelReceiveRing.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+namespace ut
+{
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveRing_PushPop)
+{
+    ChannelReceiveRing ring(3);
+    BOOST_CHECK_EQUAL(ring.getCapacity(), 4u);
+    BOOST_CHECK(ring.tryPop() == nullptr);
+
+    std::vector<Message::Pointer> messages;
+    for(size_t i = 0; i < 5; ++i)
+    {
+        messages.push_back(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    }
+
+    for(size_t i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK(ring.push(messages[i]));
+    }
+
+    BOOST_CHECK(!ring.push(messages[4]));
+    BOOST_CHECK_EQUAL(ring.getDroppedMessagesCount(), 1u);
+
+    for(size_t i = 0; i < 4; ++i)
+    {
+        BOOST_CHECK(ring.tryPop() == messages[i]);
+    }
+
+    BOOST_CHECK(ring.tryPop() == nullptr);
+    BOOST_CHECK(ring.pop(std::chrono::milliseconds(1)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveRing_NotifyOnSpace)
+{
+    ChannelReceiveRing ring(2);
+    auto message = std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    ring.push(message);
+    ring.push(message);
+    BOOST_CHECK(ring.full());
+
+    size_t notificationsCount = 0;
+    ring.notifyOnSpace([&notificationsCount]() { ++notificationsCount; });
+    BOOST_CHECK_EQUAL(notificationsCount, 0u);
+
+    ring.tryPop();
+    ring.tryPop();
+    BOOST_CHECK_EQUAL(notificationsCount, 1u);
+    BOOST_CHECK(!ring.full());
+
+    ring.notifyOnSpace([&notificationsCount]() { ++notificationsCount; });
+    BOOST_CHECK_EQUAL(notificationsCount, 2u);
+    BOOST_CHECK_EQUAL(ring.getDroppedMessagesCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveRing_Close)
+{
+    ChannelReceiveRing ring(4);
+    auto message = std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    ring.push(message);
+
+    const error::Error e(error::ErrorCode::USB_TRANSFER, 5);
+    ring.close(e);
+
+    BOOST_CHECK(ring.isClosed());
+    BOOST_CHECK(ring.getError() == e);
+    BOOST_CHECK(ring.pop() == message);
+    BOOST_CHECK(ring.pop() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelReceiveRing_ConsumerThread)
+{
+    const size_t messagesCount = 100000;
+    ChannelReceiveRing ring(16);
+
+    std::vector<Message::Pointer> received;
+    std::thread consumer([&]() {
+        while(auto message = ring.pop())
+        {
+            received.push_back(std::move(message));
+        }
+    });
+
+    std::vector<Message::Pointer> sent;
+    for(size_t i = 0; i < messagesCount; ++i)
+    {
+        auto message = std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+        sent.push_back(message);
+
+        while(!ring.push(message))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    ring.close();
+    consumer.join();
+
+    BOOST_CHECK(received == sent);
+}
+
+}
+}
+}
+}
@@ -0,0 +1,226 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <f1x/aasdk/Messenger/ChannelSendQueue.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+ChannelSendQueue::ChannelSendQueue()
+    : virtualTime_(0)
+{
+    // control traffic first, then audio, then video and microphone data
+    for(auto channelId : {ChannelId::CONTROL, ChannelId::INPUT, ChannelId::SENSOR, ChannelId::BLUETOOTH})
+    {
+        this->setChannelClass(channelId, 0);
+    }
+
+    for(auto channelId : {ChannelId::MEDIA_AUDIO, ChannelId::SPEECH_AUDIO, ChannelId::SYSTEM_AUDIO})
+    {
+        this->setChannelClass(channelId, 1);
+    }
+
+    for(auto channelId : {ChannelId::VIDEO, ChannelId::AV_INPUT})
+    {
+        this->setChannelClass(channelId, 2);
+    }
+}
+
+void ChannelSendQueue::setClass(size_t classId, size_t priority, size_t weight)
+{
+    // classes that were not configured yet get a priority equal to their id
+    for(auto id = classes_.size(); id <= classId; ++id)
+    {
+        classes_.push_back(Class{id, 1});
+    }
+
+    classes_[classId] = Class{priority, std::max<size_t>(weight, 1)};
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    statistics_.resize(classes_.size(), Statistics{0, 0, 0, std::chrono::microseconds(0), std::chrono::microseconds(0)});
+}
+
+void ChannelSendQueue::setChannelClass(ChannelId channelId, size_t classId)
+{
+    if(classId >= classes_.size())
+    {
+        this->setClass(classId, classId, 1);
+    }
+
+    auto& channel = this->getChannel(channelId);
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    statistics_[channel.classId].queueDepth -= channel.queue.size();
+    statistics_[classId].queueDepth += channel.queue.size();
+    statistics_[classId].maxQueueDepth = std::max(statistics_[classId].maxQueueDepth, statistics_[classId].queueDepth);
+    channel.classId = classId;
+}
+
+void ChannelSendQueue::push(Message::Pointer message, SendPromise::Pointer promise)
+{
+    auto& channel = this->getChannel(message->getChannelId());
+
+    if(channel.queue.empty())
+    {
+        channel.startTag = std::max(channel.finishTag, virtualTime_);
+    }
+
+    channel.queue.push_back(QueueElement{std::move(message), std::move(promise), std::chrono::steady_clock::now()});
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    auto& statistics = statistics_[channel.classId];
+    ++statistics.queueDepth;
+    statistics.maxQueueDepth = std::max(statistics.maxQueueDepth, statistics.queueDepth);
+}
+
+std::pair<Message::Pointer, SendPromise::Pointer> ChannelSendQueue::pop()
+{
+    Channel* selectedChannel = nullptr;
+    uint64_t selectedFinishTag = 0;
+
+    for(auto& channelEntry : channels_)
+    {
+        auto& channel = channelEntry.second;
+
+        if(channel.busy || channel.queue.empty())
+        {
+            continue;
+        }
+
+        const auto& channelClass = classes_[channel.classId];
+        const uint64_t size = channel.queue.front().message->getPayload().size() + 1;
+        const auto finishTag = channel.startTag + size * cWeightScale / channelClass.weight;
+
+        if(selectedChannel == nullptr
+           || channelClass.priority < classes_[selectedChannel->classId].priority
+           || (channelClass.priority == classes_[selectedChannel->classId].priority && finishTag < selectedFinishTag))
+        {
+            selectedChannel = &channel;
+            selectedFinishTag = finishTag;
+        }
+    }
+
+    virtualTime_ = selectedChannel->startTag;
+    selectedChannel->finishTag = selectedFinishTag;
+    selectedChannel->startTag = selectedFinishTag;
+    selectedChannel->busy = true;
+
+    auto queueElement = std::move(selectedChannel->queue.front());
+    selectedChannel->queue.pop_front();
+
+    const auto waitTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queueElement.enqueueTime);
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    auto& statistics = statistics_[selectedChannel->classId];
+    --statistics.queueDepth;
+    ++statistics.sentMessagesCount;
+    statistics.totalWaitTime += waitTime;
+    statistics.maxWaitTime = std::max(statistics.maxWaitTime, waitTime);
+
+    return std::make_pair(std::move(queueElement.message), std::move(queueElement.promise));
+}
+
+void ChannelSendQueue::release(ChannelId channelId)
+{
+    auto& channel = this->getChannel(channelId);
+    channel.busy = false;
+    channel.startTag = std::max(channel.finishTag, virtualTime_);
+}
+
+bool ChannelSendQueue::ready() const
+{
+    return std::any_of(channels_.begin(), channels_.end(), [](const auto& channelEntry) { return !channelEntry.second.busy && !channelEntry.second.queue.empty(); });
+}
+
+bool ChannelSendQueue::readyAtTopPriority() const
+{
+    if(classes_.empty())
+    {
+        return false;
+    }
+
+    const auto topPriority = std::min_element(classes_.begin(), classes_.end(), [](const auto& a, const auto& b) { return a.priority < b.priority; })->priority;
+
+    return std::any_of(channels_.begin(), channels_.end(), [&](const auto& channelEntry) {
+        const auto& channel = channelEntry.second;
+        return !channel.busy && !channel.queue.empty() && classes_[channel.classId].priority == topPriority;
+    });
+}
+
+void ChannelSendQueue::reject(const error::Error& e)
+{
+    for(auto& channelEntry : channels_)
+    {
+        auto& queue = channelEntry.second.queue;
+
+        while(!queue.empty())
+        {
+            auto queueElement(std::move(queue.front()));
+            queue.pop_front();
+            queueElement.promise->reject(e);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    for(auto& statistics : statistics_)
+    {
+        statistics.queueDepth = 0;
+    }
+}
+
+std::vector<ChannelSendQueue::Statistics> ChannelSendQueue::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+    return statistics_;
+}
+
+void ChannelSendQueue::resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex_);
+
+    for(auto& statistics : statistics_)
+    {
+        statistics = Statistics{statistics.queueDepth, statistics.queueDepth, 0, std::chrono::microseconds(0), std::chrono::microseconds(0)};
+    }
+}
+
+ChannelSendQueue::Channel& ChannelSendQueue::getChannel(ChannelId channelId)
+{
+    auto channel = channels_.find(channelId);
+
+    if(channel == channels_.end())
+    {
+        if(classes_.empty())
+        {
+            this->setClass(0, 0, 1);
+        }
+
+        channel = channels_.emplace(channelId, Channel{0, virtualTime_, virtualTime_, false, {}}).first;
+    }
+
+    return channel->second;
+}
+
+}
+}
+}
@@ -0,0 +1,132 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/Messenger/ChannelSendQueue.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+namespace ut
+{
+
+class ChannelSendQueueUnitTest
+{
+protected:
+    void push(ChannelId channelId, size_t payloadSize)
+    {
+        auto message = std::make_shared<Message>(channelId, EncryptionType::PLAIN, MessageType::SPECIFIC);
+        message->insertPayload(common::Data(payloadSize, 0x5E));
+        queue_.push(std::move(message), SendPromise::defer(ioService_));
+    }
+
+    ChannelId pop()
+    {
+        const auto channelId = queue_.pop().first->getChannelId();
+        queue_.release(channelId);
+        return channelId;
+    }
+
+    boost::asio::io_service ioService_;
+    ChannelSendQueue queue_;
+};
+
+BOOST_FIXTURE_TEST_CASE(ChannelSendQueue_StrictPriority, ChannelSendQueueUnitTest)
+{
+    this->push(ChannelId::VIDEO, 100);
+    this->push(ChannelId::MEDIA_AUDIO, 100);
+    this->push(ChannelId::VIDEO, 100);
+    this->push(ChannelId::INPUT, 100);
+
+    BOOST_CHECK(this->pop() == ChannelId::INPUT);
+    BOOST_CHECK(this->pop() == ChannelId::MEDIA_AUDIO);
+    BOOST_CHECK(this->pop() == ChannelId::VIDEO);
+    BOOST_CHECK(this->pop() == ChannelId::VIDEO);
+    BOOST_CHECK(!queue_.ready());
+}
+
+BOOST_FIXTURE_TEST_CASE(ChannelSendQueue_BusyChannel, ChannelSendQueueUnitTest)
+{
+    this->push(ChannelId::INPUT, 100);
+    this->push(ChannelId::INPUT, 100);
+    this->push(ChannelId::VIDEO, 100);
+
+    BOOST_CHECK(queue_.pop().first->getChannelId() == ChannelId::INPUT);
+    BOOST_CHECK(queue_.pop().first->getChannelId() == ChannelId::VIDEO);
+    BOOST_CHECK(!queue_.ready());
+
+    queue_.release(ChannelId::INPUT);
+    BOOST_CHECK(queue_.ready());
+    BOOST_CHECK(queue_.pop().first->getChannelId() == ChannelId::INPUT);
+}
+
+BOOST_FIXTURE_TEST_CASE(ChannelSendQueue_WeightedClasses, ChannelSendQueueUnitTest)
+{
+    queue_.setClass(3, 2, 3);
+    queue_.setChannelClass(ChannelId::MEDIA_AUDIO, 3);
+
+    for(size_t i = 0; i < 40; ++i)
+    {
+        this->push(ChannelId::VIDEO, 1000);
+        this->push(ChannelId::MEDIA_AUDIO, 1000);
+    }
+
+    size_t audioCount = 0;
+    for(size_t i = 0; i < 40; ++i)
+    {
+        audioCount += this->pop() == ChannelId::MEDIA_AUDIO ? 1 : 0;
+    }
+
+    BOOST_CHECK_EQUAL(audioCount, 30u);
+}
+
+BOOST_FIXTURE_TEST_CASE(ChannelSendQueue_Statistics, ChannelSendQueueUnitTest)
+{
+    this->push(ChannelId::VIDEO, 100);
+    this->push(ChannelId::AV_INPUT, 100);
+    this->push(ChannelId::INPUT, 100);
+
+    auto statistics = queue_.getStatistics();
+    BOOST_CHECK_EQUAL(statistics[0].queueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].queueDepth, 2u);
+    BOOST_CHECK_EQUAL(statistics[2].maxQueueDepth, 2u);
+
+    this->pop();
+    this->pop();
+
+    statistics = queue_.getStatistics();
+    BOOST_CHECK_EQUAL(statistics[0].queueDepth, 0u);
+    BOOST_CHECK_EQUAL(statistics[0].sentMessagesCount, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].queueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].sentMessagesCount, 1u);
+    BOOST_CHECK(statistics[2].maxWaitTime >= statistics[2].totalWaitTime);
+
+    queue_.resetStatistics();
+    statistics = queue_.getStatistics();
+    BOOST_CHECK_EQUAL(statistics[2].queueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].maxQueueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].sentMessagesCount, 0u);
+}
+
+}
+}
+}
+}
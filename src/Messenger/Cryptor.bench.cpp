@@ -0,0 +1,391 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <ctime>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <f1x/aasdk/TCP/TCPWrapper.hpp>
+#include <f1x/aasdk/TCP/TCPEndpoint.hpp>
+#include <f1x/aasdk/Transport/SSLWrapper.hpp>
+#include <f1x/aasdk/Transport/TCPTransport.hpp>
+#include <f1x/aasdk/Messenger/Cryptor.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+namespace bench
+{
+
+// TLS 1.2 server side of the session, plays the phone.
+class TLSPeer
+{
+public:
+    TLSPeer()
+        : privateKey_(EVP_EC_gen("P-256"))
+        , certificate_(X509_new())
+        , context_(SSL_CTX_new(TLS_server_method()))
+        , ssl_(nullptr)
+        , readBIO_(BIO_new(BIO_s_mem()))
+        , writeBIO_(BIO_new(BIO_s_mem()))
+    {
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate_), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate_), 0);
+        X509_gmtime_adj(X509_getm_notAfter(certificate_), 3600);
+        X509_set_pubkey(certificate_, privateKey_);
+        X509_NAME_add_entry_by_txt(X509_get_subject_name(certificate_), "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("aasdk"), -1, -1, 0);
+        X509_set_issuer_name(certificate_, X509_get_subject_name(certificate_));
+        X509_sign(certificate_, privateKey_, EVP_sha256());
+
+        SSL_CTX_set_max_proto_version(context_, TLS1_2_VERSION);
+        SSL_CTX_use_certificate(context_, certificate_);
+        SSL_CTX_use_PrivateKey(context_, privateKey_);
+        ssl_ = SSL_new(context_);
+        SSL_set_bio(ssl_, readBIO_, writeBIO_);
+        SSL_set_accept_state(ssl_);
+    }
+
+    ~TLSPeer()
+    {
+        SSL_free(ssl_);
+        SSL_CTX_free(context_);
+        X509_free(certificate_);
+        EVP_PKEY_free(privateKey_);
+    }
+
+    void handshake(ICryptor& cryptor)
+    {
+        bool done = false;
+
+        while(!done)
+        {
+            done = cryptor.doHandshake();
+            const auto clientData = cryptor.readHandshakeBuffer();
+            BIO_write(readBIO_, clientData.data(), clientData.size());
+
+            SSL_do_handshake(ssl_);
+            const auto serverData = this->read();
+            cryptor.writeHandshakeBuffer(common::DataConstBuffer(serverData));
+        }
+    }
+
+    // every call produces one record
+    common::Data encrypt(const common::Data& payload)
+    {
+        SSL_write(ssl_, payload.data(), payload.size());
+        return this->read();
+    }
+
+    common::Data decrypt(const common::Data& record)
+    {
+        BIO_write(readBIO_, record.data(), record.size());
+        common::Data payload(record.size());
+        const auto size = SSL_read(ssl_, payload.data(), payload.size());
+        payload.resize(size > 0 ? size : 0);
+        return payload;
+    }
+
+private:
+    common::Data read()
+    {
+        common::Data data(BIO_ctrl_pending(writeBIO_));
+
+        if(!data.empty())
+        {
+            BIO_read(writeBIO_, data.data(), data.size());
+        }
+
+        return data;
+    }
+
+    EVP_PKEY* privateKey_;
+    X509* certificate_;
+    SSL_CTX* context_;
+    SSL* ssl_;
+    BIO* readBIO_;
+    BIO* writeBIO_;
+};
+
+static constexpr size_t cRecordsCount = 4000;
+static constexpr size_t cRecordSize = 0x4000;
+
+// returns combined throughput of both directions in MB/s
+double measureThroughput(bool encrypt, bool decrypt, bool directRecordLayer = false)
+{
+    auto sslWrapper = std::make_shared<transport::SSLWrapper>();
+    Cryptor cryptor(sslWrapper, directRecordLayer);
+    cryptor.init();
+
+    TLSPeer peer;
+    peer.handshake(cryptor);
+
+    const common::Data payload(cRecordSize, 0x5E);
+
+    // both sides have to accept the records of each other
+    common::Data record;
+    cryptor.encrypt(record, common::DataConstBuffer(payload));
+    BOOST_CHECK(peer.decrypt(record) == payload);
+
+    common::Data plaintext;
+    cryptor.decrypt(plaintext, common::DataConstBuffer(peer.encrypt(payload)));
+    BOOST_CHECK(plaintext == payload);
+    std::vector<common::Data> records;
+
+    if(decrypt)
+    {
+        for(size_t i = 0; i < cRecordsCount; ++i)
+        {
+            records.push_back(peer.encrypt(payload));
+        }
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    std::thread encryptThread([&]() {
+        common::Data output;
+
+        for(size_t i = 0; encrypt && i < cRecordsCount; ++i)
+        {
+            output.clear();
+            cryptor.encrypt(output, common::DataConstBuffer(payload));
+        }
+    });
+
+    std::thread decryptThread([&]() {
+        common::Data output;
+
+        for(const auto& record : records)
+        {
+            output.clear();
+            cryptor.decrypt(output, common::DataConstBuffer(record));
+        }
+    });
+
+    encryptThread.join();
+    decryptThread.join();
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - begin;
+    cryptor.deinit();
+
+    const size_t directions = (encrypt ? 1 : 0) + (decrypt ? 1 : 0);
+    return directions * cRecordsCount * cRecordSize / duration.count() / (1024 * 1024);
+}
+
+// returns encrypted frames per second
+double measureEncryptRate(size_t batchSize)
+{
+    static constexpr size_t cFramesCount = 40000;
+
+    auto sslWrapper = std::make_shared<transport::SSLWrapper>();
+    Cryptor cryptor(sslWrapper);
+    cryptor.init();
+
+    TLSPeer peer;
+    peer.handshake(cryptor);
+
+    // microphone sized frames
+    const common::Data payload(2048, 0x5E);
+    std::vector<common::Data> outputs(batchSize);
+    const std::vector<common::DataConstBuffer> buffers(batchSize, common::DataConstBuffer(payload));
+
+    const auto encrypt = [&]() {
+        for(auto& output : outputs)
+        {
+            output.clear();
+        }
+
+        if(batchSize == 1)
+        {
+            cryptor.encrypt(outputs[0], buffers[0]);
+        }
+        else
+        {
+            cryptor.encryptBatch(outputs, buffers);
+        }
+    };
+
+    // the peer has to accept the records as they are
+    encrypt();
+    for(const auto& output : outputs)
+    {
+        BOOST_CHECK(peer.decrypt(output) == payload);
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    for(size_t i = 0; i < cFramesCount; i += batchSize)
+    {
+        encrypt();
+    }
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - begin;
+    cryptor.deinit();
+
+    return cFramesCount / duration.count();
+}
+
+BOOST_AUTO_TEST_CASE(Cryptor_BatchEncrypt)
+{
+    for(size_t batchSize : {1, 4, 16})
+    {
+        std::cout << "cryptor encrypt batch " << batchSize << ":       " << measureEncryptRate(batchSize) << " frames/s" << std::endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Cryptor_ConcurrentEncryptDecrypt)
+{
+    // both directions share the SSL object on the BIO path, so only the direct record layer runs them concurrently
+    std::cout << "cryptor encrypt only:          " << measureThroughput(true, false, true) << " MB/s" << std::endl;
+    std::cout << "cryptor decrypt only:          " << measureThroughput(false, true, true) << " MB/s" << std::endl;
+    std::cout << "cryptor encrypt and decrypt:   " << measureThroughput(true, true, true) << " MB/s" << std::endl;
+    std::cout << "cryptor bio serialized:        " << measureThroughput(true, true, false) << " MB/s" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(Cryptor_DirectRecordLayer)
+{
+    std::cout << "cryptor bio encrypt:           " << measureThroughput(true, false, false) << " MB/s" << std::endl;
+    std::cout << "cryptor direct encrypt:        " << measureThroughput(true, false, true) << " MB/s" << std::endl;
+    std::cout << "cryptor bio decrypt:           " << measureThroughput(false, true, false) << " MB/s" << std::endl;
+    std::cout << "cryptor direct decrypt:        " << measureThroughput(false, true, true) << " MB/s" << std::endl;
+}
+
+double getProcessCPUTime()
+{
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Phone side records go over a loopback TCPTransport and are decrypted as they arrive,
+// returns CPU time of the whole process spent per received MB in milliseconds.
+double measureTCPReceiveCost(bool encrypted, bool directRecordLayer)
+{
+    auto sslWrapper = std::make_shared<transport::SSLWrapper>();
+    Cryptor cryptor(sslWrapper, directRecordLayer);
+    cryptor.init();
+
+    TLSPeer peer;
+    peer.handshake(cryptor);
+
+    const common::Data payload(cRecordSize, 0x5E);
+    std::vector<common::Data> records;
+    size_t totalSize = 0;
+
+    for(size_t i = 0; i < cRecordsCount; ++i)
+    {
+        records.push_back(encrypted ? peer.encrypt(payload) : payload);
+        totalSize += records.back().size();
+    }
+
+    boost::asio::io_service ioService;
+    boost::asio::ip::tcp::acceptor acceptor(ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    auto sendSocket = std::make_shared<boost::asio::ip::tcp::socket>(ioService);
+    auto receiveSocket = std::make_shared<boost::asio::ip::tcp::socket>(ioService);
+    sendSocket->connect(acceptor.local_endpoint());
+    acceptor.accept(*receiveSocket);
+
+    tcp::TCPWrapper tcpWrapper;
+    auto sendTransport = std::make_shared<transport::TCPTransport>(ioService, std::make_shared<tcp::TCPEndpoint>(tcpWrapper, sendSocket));
+    auto receiveTransport = std::make_shared<transport::TCPTransport>(ioService, std::make_shared<tcp::TCPEndpoint>(tcpWrapper, receiveSocket));
+
+    std::promise<void> done;
+    size_t receivedSize = 0;
+    common::Data pending;
+    common::Data plaintext;
+
+    std::function<void()> receive = [&]() {
+        auto promise = transport::ITransport::ReceivePromise::defer(ioService);
+        promise->then([&](common::DataSlice slice) {
+                receivedSize += slice.size;
+
+                // the messenger hands whole records to the cryptor, one per frame
+                common::copy(pending, common::DataConstBuffer(slice));
+                size_t offset = 0;
+
+                while(encrypted && pending.size() - offset >= RecordCipher::cHeaderSize)
+                {
+                    const size_t recordSize = RecordCipher::cHeaderSize + ((pending[offset + 3] << 8) | pending[offset + 4]);
+                    if(pending.size() - offset < recordSize)
+                    {
+                        break;
+                    }
+
+                    plaintext.clear();
+                    cryptor.decrypt(plaintext, common::DataConstBuffer(&pending[offset], recordSize));
+                    offset += recordSize;
+                }
+
+                pending.erase(pending.begin(), encrypted ? pending.begin() + offset : pending.end());
+
+                if(receivedSize == totalSize)
+                {
+                    done.set_value();
+                }
+                else
+                {
+                    receive();
+                }
+            },
+            [](const error::Error& e) { BOOST_FAIL(e.what()); });
+
+        receiveTransport->receiveAvailable(std::move(promise));
+    };
+
+    receive();
+
+    for(auto& record : records)
+    {
+        auto promise = transport::ITransport::SendPromise::defer(ioService);
+        promise->then([]() {}, [](const error::Error& e) { BOOST_FAIL(e.what()); });
+        sendTransport->send(common::DataSequence(std::move(record)), std::move(promise));
+    }
+
+    const auto begin = getProcessCPUTime();
+    std::thread thread([&ioService]() { ioService.run(); });
+    done.get_future().wait();
+    const auto cpuTime = getProcessCPUTime() - begin;
+
+    ioService.post([&]() {
+        sendTransport->stop();
+        receiveTransport->stop();
+    });
+    ioService.stop();
+    thread.join();
+    cryptor.deinit();
+
+    return cpuTime * 1000 / (totalSize / (1024.0 * 1024.0));
+}
+
+BOOST_AUTO_TEST_CASE(Cryptor_TCPLoopbackReceiveCost)
+{
+    std::cout << "tcp loopback plain:            " << measureTCPReceiveCost(false, false) << " ms CPU/MB" << std::endl;
+    std::cout << "tcp loopback cryptor bio:      " << measureTCPReceiveCost(true, false) << " ms CPU/MB" << std::endl;
+    std::cout << "tcp loopback cryptor direct:   " << measureTCPReceiveCost(true, true) << " ms CPU/MB" << std::endl;
+}
+
+}
+}
+}
+}
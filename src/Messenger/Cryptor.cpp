@@ -28,7 +28,7 @@ namespace aasdk
 namespace messenger
 {
 
-Cryptor::Cryptor(transport::ISSLWrapper::Pointer sslWrapper)
+Cryptor::Cryptor(transport::ISSLWrapper::Pointer sslWrapper, bool directRecordLayer)
     : sslWrapper_(std::move(sslWrapper))
     , maxBufferSize_(1024 * 20)
     , certificate_(nullptr)
@@ -36,13 +36,16 @@ Cryptor::Cryptor(transport::ISSLWrapper::Pointer sslWrapper)
     , context_(nullptr)
     , ssl_(nullptr)
     , isActive_(false)
+    , directRecordLayer_(directRecordLayer)
 {
 
 }
 
 void Cryptor::init()
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_, std::defer_lock);
+    std::lock(readLock, writeLock);
 
     certificate_ = sslWrapper_->readCertificate(cCertificate);
 
@@ -108,7 +111,14 @@ void Cryptor::init()
 
 void Cryptor::deinit()
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_, std::defer_lock);
+    std::lock(readLock, writeLock);
+
+    writeCipher_.reset();
+    readCipher_.reset();
+    recordKeys_ = transport::ISSLWrapper::RecordKeys();
+    finishedExplicitNonce_.clear();
 
     if(ssl_ != nullptr)
     {
@@ -139,7 +149,9 @@ void Cryptor::deinit()
 
 bool Cryptor::doHandshake()
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_, std::defer_lock);
+    std::lock(readLock, writeLock);
 
     auto result = sslWrapper_->doHandshake(ssl_);
     if(result == SSL_ERROR_WANT_READ)
@@ -148,6 +160,11 @@ bool Cryptor::doHandshake()
     }
     else if(result == SSL_ERROR_NONE)
     {
+        if(directRecordLayer_ && !isActive_)
+        {
+            this->startDirectRecordLayer();
+        }
+
         isActive_ = true;
         return true;
     }
@@ -159,8 +176,154 @@ bool Cryptor::doHandshake()
 
 size_t Cryptor::encrypt(common::Data& output, const common::DataConstBuffer& buffer)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_);
+
+    if(writeCipher_ == nullptr)
+    {
+        this->lockSSL(readLock, writeLock);
+    }
+
+    if(writeCipher_ != nullptr)
+    {
+        return writeCipher_->encrypt(output, buffer);
+    }
+
+    this->doEncrypt(buffer);
+    return this->read(output);
+}
+
+std::vector<size_t> Cryptor::encryptBatch(std::vector<common::Data>& outputs, const std::vector<common::DataConstBuffer>& buffers)
+{
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_);
+
+    if(writeCipher_ == nullptr)
+    {
+        this->lockSSL(readLock, writeLock);
+    }
+
+    std::vector<size_t> sizes;
+    sizes.reserve(buffers.size());
+    outputs.resize(std::max(outputs.size(), buffers.size()));
+
+    if(writeCipher_ != nullptr)
+    {
+        for(size_t i = 0; i < buffers.size(); ++i)
+        {
+            sizes.push_back(writeCipher_->encrypt(outputs[i], buffers[i]));
+        }
+
+        return sizes;
+    }
+
+    // anything already pending goes out with the first record, as in encrypt()
+    size_t pendingSize = 0;
+
+    try
+    {
+        for(const auto& buffer : buffers)
+        {
+            this->doEncrypt(buffer);
+
+            const auto currentPendingSize = sslWrapper_->bioCtrlPending(bIOs_.second);
+            sizes.push_back(currentPendingSize - pendingSize);
+            pendingSize = currentPendingSize;
+        }
+    }
+    catch(const error::Error&)
+    {
+        // records of the buffers encrypted so far must not lead the output of the next call
+        common::Data discardedRecords;
+        this->read(discardedRecords);
+        throw;
+    }
+
+    // records are drained in one go, each straight into its output
+    for(size_t i = 0; i < sizes.size(); ++i)
+    {
+        this->read(outputs[i], sizes[i]);
+    }
+
+    return sizes;
+}
+
+void Cryptor::lockSSL(std::unique_lock<std::mutex>& readLock, std::unique_lock<std::mutex>& writeLock)
+{
+    // SSL_read may write alerts to the write BIO and both directions share the SSL error state, so without
+    // the record ciphers a single SSL* is used by one direction at a time
+    if(readLock.owns_lock())
+    {
+        readLock.unlock();
+    }
+
+    if(writeLock.owns_lock())
+    {
+        writeLock.unlock();
+    }
+
+    std::lock(readLock, writeLock);
+}
+
+void Cryptor::startDirectRecordLayer()
+{
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+    // the first records after the Finished messages carry sequence number 1, anything already buffered in OpenSSL
+    // would be out of reach of the record ciphers, so such a session stays on the BIOs
+    if(sslWrapper_->bioCtrlPending(bIOs_.first) == 0 && sslWrapper_->getAvailableBytes(ssl_) == 0 && sslWrapper_->getRecordKeys(ssl_, recordKeys_))
+    {
+        readCipher_ = std::make_unique<RecordCipher>(recordKeys_.cipher, recordKeys_.readKey, recordKeys_.readIV, recordKeys_.explicitNonceSize, false, 1);
+        OPENSSL_cleanse(recordKeys_.readKey.data(), recordKeys_.readKey.size());
+        this->startDirectWrite();
+    }
+#endif
+}
 
+void Cryptor::startDirectWrite()
+{
+    // OpenSSL counts GCM explicit nonces from a random start, they continue from the one of our Finished record
+    if(recordKeys_.cipher == nullptr || finishedExplicitNonce_.size() < recordKeys_.explicitNonceSize)
+    {
+        return;
+    }
+
+    uint64_t explicitNonce = 0;
+    for(size_t i = 0; i < recordKeys_.explicitNonceSize; ++i)
+    {
+        explicitNonce = (explicitNonce << 8) | finishedExplicitNonce_[i];
+    }
+
+    writeCipher_ = std::make_unique<RecordCipher>(recordKeys_.cipher, recordKeys_.writeKey, recordKeys_.writeIV, recordKeys_.explicitNonceSize, true, 1, explicitNonce + 1);
+    OPENSSL_cleanse(recordKeys_.writeKey.data(), recordKeys_.writeKey.size());
+    recordKeys_ = transport::ISSLWrapper::RecordKeys();
+}
+
+void Cryptor::findFinishedExplicitNonce(const common::Data& records)
+{
+    bool changeCipherSpec = false;
+
+    for(size_t offset = 0; offset + RecordCipher::cHeaderSize <= records.size();)
+    {
+        const size_t length = (records[offset + 3] << 8) | records[offset + 4];
+
+        // a truncated record ends the walk
+        if(offset + RecordCipher::cHeaderSize + length > records.size())
+        {
+            break;
+        }
+
+        if(changeCipherSpec && length >= 8)
+        {
+            finishedExplicitNonce_.assign(records.begin() + offset + RecordCipher::cHeaderSize, records.begin() + offset + RecordCipher::cHeaderSize + 8);
+        }
+
+        changeCipherSpec = records[offset] == SSL3_RT_CHANGE_CIPHER_SPEC;
+        offset += RecordCipher::cHeaderSize + length;
+    }
+}
+
+void Cryptor::doEncrypt(const common::DataConstBuffer& buffer)
+{
     size_t totalWrittenBytes = 0;
 
     while(totalWrittenBytes < buffer.size)
@@ -175,25 +338,64 @@ size_t Cryptor::encrypt(common::Data& output, const common::DataConstBuffer& buf
 
         totalWrittenBytes += writeSize;
     }
-
-    return this->read(output);
 }
 
 size_t Cryptor::decrypt(common::Data& output, const common::DataConstBuffer& buffer)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    {
+        std::lock_guard<decltype(readMutex_)> lock(readMutex_);
 
-    this->write(buffer);
+        if(readCipher_ != nullptr)
+        {
+            return readCipher_->decrypt(output, buffer);
+        }
+    }
+
+    // plaintext is never larger than the record it comes from
     const size_t beginOffset = output.size();
-    output.resize(beginOffset + 1);
+    output.resize(beginOffset + buffer.size);
 
-    size_t availableBytes = 1;
+    try
+    {
+        const auto size = this->decryptInto(common::DataBuffer(output, beginOffset), buffer);
+        output.resize(beginOffset + size);
+        return size;
+    }
+    catch(const error::Error&)
+    {
+        output.resize(beginOffset);
+        throw;
+    }
+}
+
+size_t Cryptor::decryptInto(common::DataBuffer output, const common::DataConstBuffer& buffer)
+{
+    std::unique_lock<std::mutex> readLock(readMutex_);
+    std::unique_lock<std::mutex> writeLock(writeMutex_, std::defer_lock);
+
+    if(readCipher_ == nullptr)
+    {
+        this->lockSSL(readLock, writeLock);
+    }
+
+    if(readCipher_ != nullptr)
+    {
+        return readCipher_->decrypt(output, buffer);
+    }
+
+    this->write(buffer);
     size_t totalReadSize = 0;
 
-    while(availableBytes > 0)
+    do
     {
-        const auto& currentBuffer = common::DataBuffer(output, totalReadSize + beginOffset);
-        auto readSize = sslWrapper_->sslRead(ssl_, currentBuffer.data, currentBuffer.size);
+        const common::DataBuffer currentBuffer(output.data, output.size, totalReadSize);
+
+        if(currentBuffer.size == 0)
+        {
+            throw error::Error(error::ErrorCode::SSL_READ, SSL_ERROR_SSL);
+        }
+
+        const auto readSize = sslWrapper_->sslRead(ssl_, currentBuffer.data, currentBuffer.size);
 
         if(readSize <= 0)
         {
@@ -201,33 +403,46 @@ size_t Cryptor::decrypt(common::Data& output, const common::DataConstBuffer& buf
         }
 
         totalReadSize += readSize;
-        availableBytes = sslWrapper_->getAvailableBytes(ssl_);
-        output.resize(output.size() + availableBytes);
     }
+    while(sslWrapper_->getAvailableBytes(ssl_) > 0);
 
     return totalReadSize;
 }
 
 common::Data Cryptor::readHandshakeBuffer()
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_, std::defer_lock);
+    std::lock(readLock, writeLock);
 
     common::Data output;
     this->read(output);
+
+    if(directRecordLayer_ && writeCipher_ == nullptr)
+    {
+        this->findFinishedExplicitNonce(output);
+        this->startDirectWrite();
+    }
+
     return output;
 }
 
 void Cryptor::writeHandshakeBuffer(const common::DataConstBuffer& buffer)
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
+    std::unique_lock<std::mutex> readLock(readMutex_, std::defer_lock);
+    std::unique_lock<std::mutex> writeLock(writeMutex_, std::defer_lock);
+    std::lock(readLock, writeLock);
 
     this->write(buffer);
 }
 
 size_t Cryptor::read(common::Data& output)
 {
-    const auto pendingSize = sslWrapper_->bioCtrlPending(bIOs_.second);
+    return this->read(output, sslWrapper_->bioCtrlPending(bIOs_.second));
+}
 
+size_t Cryptor::read(common::Data& output, size_t pendingSize)
+{
     size_t beginOffset = output.size();
     output.resize(beginOffset + pendingSize);
     size_t totalReadSize = 0;
@@ -268,8 +483,6 @@ void Cryptor::write(const common::DataConstBuffer& buffer)
 
 bool Cryptor::isActive() const
 {
-    std::lock_guard<decltype(mutex_)> lock(mutex_);
-
     return isActive_;
 }
 
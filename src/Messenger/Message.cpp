@@ -29,6 +29,7 @@ Message::Message(ChannelId channelId, EncryptionType encryptionType, MessageType
     : channelId_(channelId)
     , encryptionType_(encryptionType)
     , type_(type)
+    , payload_(common::DataAllocator<uint8_t>(cPayloadHeadroomSize))
 {
 }
 
@@ -66,6 +67,14 @@ MessageType Message::getType() const
     return type_;
 }
 
+void Message::reset(ChannelId channelId, EncryptionType encryptionType, MessageType type)
+{
+    channelId_ = channelId;
+    encryptionType_ = encryptionType;
+    type_ = type;
+    payload_.clear();
+}
+
 common::Data& Message::getPayload()
 {
     return payload_;
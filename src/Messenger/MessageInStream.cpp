@@ -16,7 +16,9 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <f1x/aasdk/Messenger/MessageInStream.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
 #include <f1x/aasdk/Error/Error.hpp>
 
 namespace f1x
@@ -26,10 +28,21 @@ namespace aasdk
 namespace messenger
 {
 
-MessageInStream::MessageInStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor)
+MessageInStream::MessageInStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor, size_t maxMessageSize,
+                                 io::PipelineStage::Pointer cryptoStage)
     : strand_(ioService)
     , transport_(std::move(transport))
     , cryptor_(std::move(cryptor))
+    , state_(ParserState::FRAME_HEADER)
+    , recentFrameType_(FrameType::BULK)
+    , framePayloadSize_(0)
+    , payloadReserveSize_(0)
+    , maxMessageSize_(maxMessageSize)
+    , cryptoStage_(std::move(cryptoStage))
+    , decryptionsCount_(0)
+    , finishedDecryptionsCount_(0)
+    , generation_(0)
+    , isReceiving_(false)
 {
 
 }
@@ -41,17 +54,21 @@ void MessageInStream::startReceive(ReceivePromise::Pointer promise)
         {
             promise_ = std::move(promise);
 
-            auto transportPromise = transport::ITransport::ReceivePromise::defer(strand_);
-            transportPromise->then(
-                [this, self = this->shared_from_this()](common::Data data) mutable {
-                    this->receiveFrameHeaderHandler(common::DataConstBuffer(data));
-                },
-                [this, self = this->shared_from_this()](const error::Error& e) mutable {
-                    promise_->reject(e);
-                    promise_.reset();
-                });
-
-            transport_->receive(FrameHeader::getSizeOf(), std::move(transportPromise));
+            if(cryptoStage_ == nullptr)
+            {
+                this->receive();
+            }
+            else if(error_ != error::ErrorCode::NONE)
+            {
+                // failure of the pipeline while nobody was waiting for a message
+                promise_->reject(error_);
+                promise_.reset();
+                error_ = error::Error();
+            }
+            else
+            {
+                this->receivePipelined();
+            }
         }
         else
         {
@@ -60,97 +77,395 @@ void MessageInStream::startReceive(ReceivePromise::Pointer promise)
     });
 }
 
-void MessageInStream::receiveFrameHeaderHandler(const common::DataConstBuffer& buffer)
+void MessageInStream::receive()
 {
-    FrameHeader frameHeader(buffer);
+    Message::Pointer message;
 
-    if(message_ == nullptr)
+    try
+    {
+        message = this->parse();
+    }
+    catch(const error::Error& e)
     {
-        message_ = std::make_shared<Message>(frameHeader.getChannelId(), frameHeader.getEncryptionType(), frameHeader.getMessageType());
+        this->reject(e);
+        return;
     }
-    else if(message_->getChannelId() != frameHeader.getChannelId())
+
+    if(receivedData_.size == 0)
     {
-        message_.reset();
-        promise_->reject(error::Error(error::ErrorCode::MESSENGER_INTERTWINED_CHANNELS));
+        receivedData_ = common::DataSlice();
+    }
+
+    if(message != nullptr)
+    {
+        promise_->resolve(std::move(message));
         promise_.reset();
+    }
+    else
+    {
+        auto transportPromise = transport::ITransport::ReceivePromise::defer(strand_);
+        transportPromise->then(
+            [this, self = this->shared_from_this()](common::DataSlice slice) mutable {
+                receivedData_ = std::move(slice);
+                this->receive();
+            },
+            [this, self = this->shared_from_this()](const error::Error& e) mutable {
+                this->reject(e);
+            });
+
+        transport_->receiveAvailable(std::move(transportPromise));
+    }
+}
+
+void MessageInStream::receivePipelined()
+{
+    if(error_ != error::ErrorCode::NONE)
+    {
         return;
     }
 
-    recentFrameType_ = frameHeader.getType();
-    const size_t frameSize = FrameSize::getSizeOf(frameHeader.getType() == FrameType::FIRST ? FrameSizeType::EXTENDED : FrameSizeType::SHORT);
+    // parsing runs ahead of the receiver, as far as the pipeline depth allows
+    try
+    {
+        while(!this->isPipelineFull())
+        {
+            auto message = this->parse();
 
-    auto transportPromise = transport::ITransport::ReceivePromise::defer(strand_);
-    transportPromise->then(
-        [this, self = this->shared_from_this()](common::Data data) mutable {
-            this->receiveFrameSizeHandler(common::DataConstBuffer(data));
-        },
-        [this, self = this->shared_from_this()](const error::Error& e) mutable {
-            message_.reset();
-            promise_->reject(e);
-            promise_.reset();
-        });
+            if(message == nullptr)
+            {
+                break;
+            }
+
+            completedMessages_.push_back(CompletedMessage{std::move(message), decryptionsCount_});
+        }
+    }
+    catch(const error::Error& e)
+    {
+        this->fail(e);
+        return;
+    }
 
-    transport_->receive(frameSize, std::move(transportPromise));
+    if(receivedData_.size == 0)
+    {
+        receivedData_ = common::DataSlice();
+    }
+
+    this->deliver();
+
+    // a full pipeline is resumed by finished decryptions and delivered messages
+    if(!isReceiving_ && !this->isPipelineFull())
+    {
+        this->receiveFromTransport();
+    }
 }
 
-void MessageInStream::receiveFrameSizeHandler(const common::DataConstBuffer& buffer)
+void MessageInStream::receiveFromTransport()
 {
+    isReceiving_ = true;
+
     auto transportPromise = transport::ITransport::ReceivePromise::defer(strand_);
     transportPromise->then(
-        [this, self = this->shared_from_this()](common::Data data) mutable {
-            this->receiveFramePayloadHandler(common::DataConstBuffer(data));
+        [this, self = this->shared_from_this()](common::DataSlice slice) mutable {
+            isReceiving_ = false;
+            receivedData_ = std::move(slice);
+            this->receivePipelined();
         },
         [this, self = this->shared_from_this()](const error::Error& e) mutable {
-            message_.reset();
-            promise_->reject(e);
-            promise_.reset();
+            isReceiving_ = false;
+            this->fail(e);
         });
 
-    FrameSize frameSize(buffer);
-    transport_->receive(frameSize.getSize(), std::move(transportPromise));
+    transport_->receiveAvailable(std::move(transportPromise));
 }
 
-void MessageInStream::receiveFramePayloadHandler(const common::DataConstBuffer& buffer)
-{   
-    if(message_->getEncryptionType() == EncryptionType::ENCRYPTED)
+void MessageInStream::deliver()
+{
+    if(promise_ != nullptr && !completedMessages_.empty() && completedMessages_.front().decryptionsCount <= finishedDecryptionsCount_)
     {
+        promise_->resolve(std::move(completedMessages_.front().message));
+        promise_.reset();
+        completedMessages_.pop_front();
+    }
+}
+
+bool MessageInStream::isPipelineFull() const
+{
+    return completedMessages_.size() >= cMaxPipelineDepth || decryptionsCount_ - finishedDecryptionsCount_ >= cMaxPipelineDepth;
+}
+
+void MessageInStream::postDecryption(const common::DataConstBuffer& buffer)
+{
+    // the frame payload stays where it was received, or is taken over from the collected partial data
+    common::DataSlice framePayload(partialData_.empty() ? common::DataSlice(receivedData_.owner, buffer) : common::DataSlice(std::move(partialData_)));
+    partialData_.clear();
+    ++decryptionsCount_;
+
+    cryptoStage_->post([this, self = this->shared_from_this(), message = message_, framePayload = std::move(framePayload), reserveSize = payloadReserveSize_, generation = generation_]() mutable {
+        error::Error error;
+
         try
         {
-            cryptor_->decrypt(message_->getPayload(), buffer);
+            this->decryptFramePayload(*message, common::DataConstBuffer(framePayload), reserveSize);
         }
         catch(const error::Error& e)
         {
-            message_.reset();
-            promise_->reject(e);
-            promise_.reset();
-            return;
+            error = e;
         }
+
+        // everything the job holds is released on the strand
+        strand_.post([this, self = std::move(self), message = std::move(message), framePayload = std::move(framePayload), generation, error]() mutable {
+            this->decryptionHandler(generation, error);
+        });
+    });
+}
+
+void MessageInStream::decryptionHandler(uint64_t generation, const error::Error& e)
+{
+    if(generation != generation_)
+    {
+        return;
+    }
+
+    if(e != error::ErrorCode::NONE)
+    {
+        this->fail(e);
+        return;
+    }
+
+    ++finishedDecryptionsCount_;
+
+    if(isReceiving_)
+    {
+        this->deliver();
     }
     else
     {
-        message_->insertPayload(buffer);
+        this->receivePipelined();
     }
+}
 
-    if(recentFrameType_ == FrameType::BULK || recentFrameType_ == FrameType::LAST)
+void MessageInStream::fail(const error::Error& e)
+{
+    if(promise_ != nullptr)
     {
-        promise_->resolve(std::move(message_));
-        promise_.reset();
+        this->reject(e);
     }
     else
     {
-        auto transportPromise = transport::ITransport::ReceivePromise::defer(strand_);
-        transportPromise->then(
-            [this, self = this->shared_from_this()](common::Data data) mutable {
-                this->receiveFrameHeaderHandler(common::DataConstBuffer(data));
-            },
-            [this, self = this->shared_from_this()](const error::Error& e) mutable {
-                message_.reset();
-                promise_->reject(e);
-                promise_.reset();
-            });
+        this->reset();
+        error_ = e;
+    }
+}
 
-        transport_->receive(FrameHeader::getSizeOf(), std::move(transportPromise));
+void MessageInStream::reset()
+{
+    message_.reset();
+    channelMessages_.fill(nullptr);
+    state_ = ParserState::FRAME_HEADER;
+    partialData_.clear();
+    completedMessages_.clear();
+    decryptionsCount_ = 0;
+    finishedDecryptionsCount_ = 0;
+    ++generation_;
+}
+
+void MessageInStream::reject(const error::Error& e)
+{
+    this->reset();
+    promise_->reject(e);
+    promise_.reset();
+}
+
+Message::Pointer MessageInStream::parse()
+{
+    // decodes frames from the received data until a message is complete, only a partially received frame is left over
+    while(true)
+    {
+        switch(state_)
+        {
+        case ParserState::FRAME_HEADER:
+            if(!this->parseFrameHeader())
+            {
+                return nullptr;
+            }
+            break;
+
+        case ParserState::FRAME_SIZE:
+            if(!this->parseFrameSize())
+            {
+                return nullptr;
+            }
+            break;
+
+        case ParserState::FRAME_PAYLOAD:
+            if(!this->parseFramePayload())
+            {
+                return nullptr;
+            }
+            else if(recentFrameType_ == FrameType::BULK || recentFrameType_ == FrameType::LAST)
+            {
+                channelMessages_[static_cast<size_t>(message_->getChannelId())].reset();
+                return std::move(message_);
+            }
+            break;
+        }
+    }
+}
+
+bool MessageInStream::parseFrameHeader()
+{
+    common::DataConstBuffer buffer;
+
+    if(!this->take(FrameHeader::getSizeOf(), buffer))
+    {
+        return false;
+    }
+
+    FrameHeader frameHeader(buffer);
+    partialData_.clear();
+
+    auto& channelMessage = channelMessages_[static_cast<size_t>(frameHeader.getChannelId())];
+
+    if(channelMessage == nullptr)
+    {
+        channelMessage = MessagePool::create(frameHeader.getChannelId(), frameHeader.getEncryptionType(), frameHeader.getMessageType());
+    }
+
+    message_ = channelMessage;
+
+    recentFrameType_ = frameHeader.getType();
+    state_ = ParserState::FRAME_SIZE;
+    return true;
+}
+
+bool MessageInStream::parseFrameSize()
+{
+    common::DataConstBuffer buffer;
+
+    if(!this->take(FrameSize::getSizeOf(recentFrameType_ == FrameType::FIRST ? FrameSizeType::EXTENDED : FrameSizeType::SHORT), buffer))
+    {
+        return false;
+    }
+
+    const FrameSize frameSize(buffer);
+    framePayloadSize_ = frameSize.getSize();
+    payloadReserveSize_ = 0;
+    partialData_.clear();
+
+    if(recentFrameType_ == FrameType::FIRST)
+    {
+        // the whole message is allocated once, following frames are decrypted and copied straight into it
+        this->checkMessageSize(frameSize.getTotalSize());
+
+        if(message_->getEncryptionType() == EncryptionType::ENCRYPTED)
+        {
+            // room for one record overhead, the last frame is decrypted into a span as big as its record,
+            // the payload is reserved by whoever decrypts the frame
+            payloadReserveSize_ = frameSize.getTotalSize() + ICryptor::cMaxRecordExpansionSize;
+        }
+        else
+        {
+            message_->getPayload().reserve(message_->getPayload().size() + frameSize.getTotalSize());
+        }
     }
+    state_ = ParserState::FRAME_PAYLOAD;
+    return true;
+}
+
+bool MessageInStream::parseFramePayload()
+{
+    if(message_->getEncryptionType() == EncryptionType::ENCRYPTED)
+    {
+        // encrypted payload can only be decrypted as a whole
+        common::DataConstBuffer buffer;
+
+        if((cryptoStage_ != nullptr && this->isPipelineFull()) || !this->take(framePayloadSize_, buffer))
+        {
+            return false;
+        }
+
+        if(cryptoStage_ != nullptr)
+        {
+            // the payload belongs to the crypto stage until the decryption is finished
+            this->postDecryption(buffer);
+        }
+        else
+        {
+            this->decryptFramePayload(*message_, buffer, payloadReserveSize_);
+            partialData_.clear();
+        }
+    }
+    else
+    {
+        const auto size = std::min(framePayloadSize_, receivedData_.size);
+
+        if(size > 0)
+        {
+            message_->insertPayload(common::DataConstBuffer(receivedData_.cdata, size));
+            this->skip(size);
+            framePayloadSize_ -= size;
+        }
+
+        if(framePayloadSize_ > 0)
+        {
+            return false;
+        }
+
+        this->checkMessageSize(message_->getPayload().size());
+    }
+
+    state_ = ParserState::FRAME_HEADER;
+    return true;
+}
+
+void MessageInStream::decryptFramePayload(Message& message, const common::DataConstBuffer& buffer, size_t reserveSize) const
+{
+    // the plaintext goes straight into the payload, reserved up front for the whole message
+    auto& payload = message.getPayload();
+    payload.reserve(payload.size() + reserveSize);
+
+    const auto beginOffset = payload.size();
+    payload.resize(beginOffset + buffer.size);
+    payload.resize(beginOffset + cryptor_->decryptInto(common::DataBuffer(payload, beginOffset), buffer));
+
+    this->checkMessageSize(payload.size());
+}
+
+void MessageInStream::checkMessageSize(size_t size) const
+{
+    if(size > maxMessageSize_)
+    {
+        throw error::Error(error::ErrorCode::MESSENGER_MESSAGE_SIZE_LIMIT, static_cast<uint32_t>(size));
+    }
+}
+
+bool MessageInStream::take(size_t size, common::DataConstBuffer& buffer)
+{
+    if(partialData_.empty() && receivedData_.size >= size)
+    {
+        buffer = common::DataConstBuffer(receivedData_.cdata, size);
+        this->skip(size);
+        return true;
+    }
+
+    // field is split between receives, collect it
+    const auto partSize = std::min(size - partialData_.size(), receivedData_.size);
+    partialData_.insert(partialData_.end(), receivedData_.cdata, receivedData_.cdata + partSize);
+    this->skip(partSize);
+
+    if(partialData_.size() < size)
+    {
+        return false;
+    }
+
+    buffer = common::DataConstBuffer(partialData_);
+    return true;
+}
+
+void MessageInStream::skip(size_t size)
+{
+    receivedData_.cdata += size;
+    receivedData_.size -= size;
 }
 
 }
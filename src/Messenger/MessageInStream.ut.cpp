@@ -16,6 +16,7 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <thread>
 #include <boost/test/unit_test.hpp>
 #include <f1x/aasdk/Transport/UT/Transport.mock.hpp>
 #include <f1x/aasdk/Messenger/UT/Cryptor.mock.hpp>
@@ -34,8 +35,8 @@ namespace ut
 
 using ::testing::_;
 using ::testing::SaveArg;
-using ::testing::SetArgReferee;
 using ::testing::Return;
+using ::testing::Invoke;
 
 class MessageInStreamUnitTest
 {
@@ -49,6 +50,26 @@ protected:
                              std::bind(&ReceivePromiseHandlerMock::onReject, &receivePromiseHandlerMock_, std::placeholders::_1));
     }
 
+    static common::Data createFrame(const FrameHeader& frameHeader, const FrameSize& frameSize, const common::Data& payload)
+    {
+        auto frame = frameHeader.getData();
+        const auto frameSizeData = frameSize.getData();
+        frame.insert(frame.end(), frameSizeData.begin(), frameSizeData.end());
+        frame.insert(frame.end(), payload.begin(), payload.end());
+        return frame;
+    }
+
+    // handlers of a crypto stage get back to the io_service from another thread
+    void runUntil(const std::function<bool()>& condition)
+    {
+        while(!condition())
+        {
+            ioService_.poll();
+            ioService_.reset();
+            std::this_thread::yield();
+        }
+    }
+
     boost::asio::io_service ioService_;
     transport::ut::TransportMock transportMock_;
     transport::ITransport::Pointer transport_;
@@ -68,9 +89,8 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceivePlainMessage, MessageInStreamUnit
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
@@ -78,25 +98,12 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceivePlainMessage, MessageInStreamUnit
     ioService_.reset();
 
     common::Data framePayload(1000, 0x5E);
-    FrameSize frameSize(framePayload.size());
-    transport::ITransport::ReceivePromise::Pointer frameSizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::SHORT), _)).WillOnce(SaveArg<1>(&frameSizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frameHeader.getData());
-
-    ioService_.run();
-    ioService_.reset();
-
-    transport::ITransport::ReceivePromise::Pointer framePayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(framePayload.size(), _)).WillOnce(SaveArg<1>(&framePayloadTransportPromise));
-    frameSizeTransportPromise->resolve(frameSize.getData());
-
-    ioService_.run();
-    ioService_.reset();
+    FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
 
     Message::Pointer message;
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
     EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
-    framePayloadTransportPromise->resolve(framePayload);
+    transportPromise->resolve(createFrame(frameHeader, FrameSize(framePayload.size()), framePayload));
 
     ioService_.run();
 
@@ -112,9 +119,8 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveEncryptedMessage, MessageInStream
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
@@ -122,28 +128,20 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveEncryptedMessage, MessageInStream
     ioService_.reset();
 
     common::Data framePayload(1000, 0x5E);
-    FrameSize frameSize(framePayload.size());
-    transport::ITransport::ReceivePromise::Pointer frameSizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::SHORT), _)).WillOnce(SaveArg<1>(&frameSizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frameHeader.getData());
-
-    ioService_.run();
-    ioService_.reset();
-
-    transport::ITransport::ReceivePromise::Promise::Pointer framePayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(framePayload.size(), _)).WillOnce(SaveArg<1>(&framePayloadTransportPromise));
+    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
 
     common::Data decryptedPayload(500, 0x5F);
-    EXPECT_CALL(cryptorMock_, decrypt(_, _)).WillOnce(DoAll(SetArgReferee<0>(decryptedPayload), Return(decryptedPayload.size())));
-    frameSizeTransportPromise->resolve(frameSize.getData());
-
-    ioService_.run();
-    ioService_.reset();
+    EXPECT_CALL(cryptorMock_, decryptInto(_, _)).WillOnce(Invoke([&](common::DataBuffer output, const common::DataConstBuffer& buffer) {
+        BOOST_CHECK(common::createData(buffer) == framePayload);
+        BOOST_CHECK_EQUAL(output.size, buffer.size);
+        std::copy(decryptedPayload.begin(), decryptedPayload.end(), output.data);
+        return decryptedPayload.size();
+    }));
 
     Message::Pointer message;
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
     EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
-    framePayloadTransportPromise->resolve(framePayload);
+    transportPromise->resolve(createFrame(frameHeader, FrameSize(framePayload.size()), framePayload));
 
     ioService_.run();
 
@@ -159,9 +157,8 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_MessageDecryptionFailed, MessageInStream
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
@@ -169,38 +166,42 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_MessageDecryptionFailed, MessageInStream
     ioService_.reset();
 
     common::Data framePayload(1000, 0x5E);
-    FrameSize frameSize(framePayload.size());
-    transport::ITransport::ReceivePromise::Pointer frameSizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::SHORT), _)).WillOnce(SaveArg<1>(&frameSizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frameHeader.getData());
+    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
+    EXPECT_CALL(cryptorMock_, decryptInto(_, _)).WillOnce(ThrowSSLReadException());
+
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(error::Error(error::ErrorCode::SSL_READ, 123)));
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
+    transportPromise->resolve(createFrame(frameHeader, FrameSize(framePayload.size()), framePayload));
 
     ioService_.run();
-    ioService_.reset();
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveFailed, MessageInStreamUnitTest)
+{
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    transport::ITransport::ReceivePromise::Pointer framePayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(framePayload.size(), _)).WillOnce(SaveArg<1>(&framePayloadTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
-    common::Data decryptedPayload(500, 0x5F);
-    EXPECT_CALL(cryptorMock_, decrypt(_, _)).WillOnce(ThrowSSLReadException());
-    frameSizeTransportPromise->resolve(frameSize.getData());
+    messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
-    EXPECT_CALL(receivePromiseHandlerMock_, onReject(error::Error(error::ErrorCode::SSL_READ, 123)));
+    error::Error e(error::ErrorCode::USB_TRANSFER, 5);
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(e));
     EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
-    framePayloadTransportPromise->resolve(framePayload);
+    transportPromise->reject(e);
 
     ioService_.run();
 }
 
-BOOST_FIXTURE_TEST_CASE(MessageInStream_FramePayloadReceiveFailed, MessageInStreamUnitTest)
+BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveFailedWithinFrame, MessageInStreamUnitTest)
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).Times(2).WillRepeatedly(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
@@ -208,17 +209,9 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_FramePayloadReceiveFailed, MessageInStre
     ioService_.reset();
 
     common::Data framePayload(1000, 0x5E);
-    FrameSize frameSize(framePayload.size());
-    transport::ITransport::ReceivePromise::Pointer frameSizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::SHORT), _)).WillOnce(SaveArg<1>(&frameSizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frameHeader.getData());
-
-    ioService_.run();
-    ioService_.reset();
-
-    transport::ITransport::ReceivePromise::Pointer framePayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(framePayload.size(), _)).WillOnce(SaveArg<1>(&framePayloadTransportPromise));
-    frameSizeTransportPromise->resolve(frameSize.getData());
+    FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    const auto frame = createFrame(frameHeader, FrameSize(framePayload.size()), framePayload);
+    transportPromise->resolve(common::Data(frame.begin(), frame.begin() + 100));
 
     ioService_.run();
     ioService_.reset();
@@ -226,67 +219,96 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_FramePayloadReceiveFailed, MessageInStre
     error::Error e(error::ErrorCode::USB_TRANSFER, 5);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(e));
     EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
-    framePayloadTransportPromise->reject(e);
+    transportPromise->reject(e);
 
     ioService_.run();
 }
 
-BOOST_FIXTURE_TEST_CASE(MessageInStream_FramePayloadSizeReceiveFailed, MessageInStreamUnitTest)
+BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveMessageInPieces, MessageInStreamUnitTest)
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
+    common::Data framePayload(1000, 0x5E);
     FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    const auto frame = createFrame(frameHeader, FrameSize(framePayload.size()), framePayload);
+
+    // pieces end inside the frame header, the frame size and the payload
+    const std::vector<size_t> pieceEnds{1, 3, 500, frame.size()};
+
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).Times(pieceEnds.size()).WillRepeatedly(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
-    transport::ITransport::ReceivePromise::Pointer frameSizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::SHORT), _)).WillOnce(SaveArg<1>(&frameSizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frameHeader.getData());
+    Message::Pointer message;
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
 
-    ioService_.run();
-    ioService_.reset();
+    size_t pieceBegin = 0;
+    for(auto pieceEnd : pieceEnds)
+    {
+        transportPromise->resolve(common::Data(frame.begin() + pieceBegin, frame.begin() + pieceEnd));
+        pieceBegin = pieceEnd;
 
-    error::Error e(error::ErrorCode::USB_TRANSFER, 5);
-    EXPECT_CALL(receivePromiseHandlerMock_, onReject(e));
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
-    frameSizeTransportPromise->reject(e);
+        ioService_.run();
+        ioService_.reset();
+    }
 
-    ioService_.run();
+    const auto& payload = message->getPayload();
+    BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), framePayload.begin(), framePayload.end());
 }
 
-BOOST_FIXTURE_TEST_CASE(MessageInStream_FrameHeaderReceiveFailed, MessageInStreamUnitTest)
+BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveEncryptedFrameInPieces, MessageInStreamUnitTest)
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    common::Data framePayload(1000, 0x5E);
+    framePayload.back() = 0x5F;
+    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
+    const auto frame = createFrame(frameHeader, FrameSize(framePayload.size()), framePayload);
+
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).Times(2).WillRepeatedly(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
-    error::Error e(error::ErrorCode::USB_TRANSFER, 5);
-    EXPECT_CALL(receivePromiseHandlerMock_, onReject(e));
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
-    frameHeaderTransportPromise->reject(e);
+    transportPromise->resolve(common::Data(frame.begin(), frame.begin() + 300));
 
     ioService_.run();
+    ioService_.reset();
+
+    // record is decrypted once it is complete
+    common::Data decryptedPayload(500, 0x60);
+    EXPECT_CALL(cryptorMock_, decryptInto(_, _)).WillOnce(Invoke([&](common::DataBuffer output, const common::DataConstBuffer& buffer) {
+        BOOST_CHECK(common::createData(buffer) == framePayload);
+        BOOST_CHECK_EQUAL(output.size, buffer.size);
+        std::copy(decryptedPayload.begin(), decryptedPayload.end(), output.data);
+        return decryptedPayload.size();
+    }));
+
+    Message::Pointer message;
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
+    transportPromise->resolve(common::Data(frame.begin() + 300, frame.end()));
+
+    ioService_.run();
+
+    const auto& payload = message->getPayload();
+    BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), decryptedPayload.begin(), decryptedPayload.end());
 }
 
 BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveSplittedMessage, MessageInStreamUnitTest)
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
-    FrameHeader frame1Header(ChannelId::BLUETOOTH, FrameType::FIRST, EncryptionType::PLAIN, MessageType::SPECIFIC);
 
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).Times(2).WillRepeatedly(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
@@ -298,110 +320,281 @@ BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveSplittedMessage, MessageInStreamU
     common::Data expectedPayload(frame1Payload.begin(), frame1Payload.end());
     expectedPayload.insert(expectedPayload.end(), frame2Payload.begin(), frame2Payload.end());
 
-    transport::ITransport::ReceivePromise::Pointer frame1SizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::EXTENDED), _)).WillOnce(SaveArg<1>(&frame1SizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frame1Header.getData());
+    FrameHeader frame1Header(ChannelId::BLUETOOTH, FrameType::FIRST, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    auto data = createFrame(frame1Header, FrameSize(frame1Payload.size(), expectedPayload.size()), frame1Payload);
+    FrameHeader frame2Header(ChannelId::BLUETOOTH, FrameType::LAST, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    const auto frame2 = createFrame(frame2Header, FrameSize(frame2Payload.size()), frame2Payload);
+    data.insert(data.end(), frame2.begin(), frame2.end());
+
+    Message::Pointer message;
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
+    transportPromise->resolve(data);
 
     ioService_.run();
-    ioService_.reset();
 
-    transport::ITransport::ReceivePromise::Pointer frame1PayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(frame1Payload.size(), _)).WillOnce(SaveArg<1>(&frame1PayloadTransportPromise));
-    FrameSize frame1Size(frame1Payload.size(), frame1Payload.size() + frame2Payload.size());
-    frame1SizeTransportPromise->resolve(frame1Size.getData());
+    BOOST_CHECK(message->getChannelId() == ChannelId::BLUETOOTH);
+    BOOST_CHECK(message->getEncryptionType() == EncryptionType::PLAIN);
+    BOOST_CHECK(message->getType() == MessageType::SPECIFIC);
 
-    ioService_.run();
-    ioService_.reset();
+    const auto& payload = message->getPayload();
+    BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), expectedPayload.begin(), expectedPayload.end());
+    BOOST_CHECK_EQUAL(payload.capacity(), expectedPayload.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageInStream_DecryptSplittedMessageIntoPayload, MessageInStreamUnitTest)
+{
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
+
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
-    frame1PayloadTransportPromise->resolve(frame1Payload);
+    messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
-    transport::ITransport::ReceivePromise::Pointer frame2SizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::SHORT), _)).WillOnce(SaveArg<1>(&frame2SizeTransportPromise));
+    // records are bigger than the plaintext they carry
+    common::Data frame1Payload(1029, 0x5E);
+    common::Data frame2Payload(2029, 0x5F);
+    common::Data expectedPayload(1000, 0x60);
+    expectedPayload.insert(expectedPayload.end(), 2000, 0x61);
+
+    FrameHeader frame1Header(ChannelId::VIDEO, FrameType::FIRST, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    auto data = createFrame(frame1Header, FrameSize(frame1Payload.size(), expectedPayload.size()), frame1Payload);
+    FrameHeader frame2Header(ChannelId::VIDEO, FrameType::LAST, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    const auto frame2 = createFrame(frame2Header, FrameSize(frame2Payload.size()), frame2Payload);
+    data.insert(data.end(), frame2.begin(), frame2.end());
+
+    std::vector<common::DataBuffer> outputs;
+    EXPECT_CALL(cryptorMock_, decryptInto(_, _)).Times(2).WillRepeatedly(Invoke([&](common::DataBuffer output, const common::DataConstBuffer& buffer) {
+        outputs.push_back(output);
+        const auto size = buffer.size - 29;
+        std::fill(output.data, output.data + size, outputs.size() == 1 ? 0x60 : 0x61);
+        return size;
+    }));
 
-    FrameHeader frame2Header(ChannelId::BLUETOOTH, FrameType::LAST, EncryptionType::PLAIN, MessageType::SPECIFIC);
-    frameHeaderTransportPromise->resolve(frame2Header.getData());
+    Message::Pointer message;
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
+    transportPromise->resolve(data);
 
     ioService_.run();
-    ioService_.reset();
 
-    transport::ITransport::ReceivePromise::Pointer frame2PayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(frame2Payload.size(), _)).WillOnce(SaveArg<1>(&frame2PayloadTransportPromise));
-    FrameSize frame2Size(frame2Payload.size());
-    frame2SizeTransportPromise->resolve(frame2Size.getData());
+    const auto& payload = message->getPayload();
+    BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), expectedPayload.begin(), expectedPayload.end());
+
+    // both frames were decrypted in place, the payload was never reallocated
+    BOOST_REQUIRE_EQUAL(outputs.size(), 2);
+    BOOST_CHECK(outputs[0].data == payload.data());
+    BOOST_CHECK(outputs[1].data == payload.data() + 1000);
+    BOOST_CHECK_EQUAL(outputs[1].size, frame2Payload.size());
+}
 
-    ioService_.run();
-    ioService_.reset();
+BOOST_FIXTURE_TEST_CASE(MessageInStream_DecryptOnCryptoStage, MessageInStreamUnitTest)
+{
+    auto cryptoStage = std::make_shared<io::PipelineStage>();
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_, 16 * 1024 * 1024, cryptoStage));
 
+    // the stream keeps receiving while frames are decrypted
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillRepeatedly(SaveArg<0>(&transportPromise));
+
+    messageInStream->startReceive(std::move(receivePromise_));
+    this->runUntil([&]() { return transportPromise != nullptr; });
+
+    common::Data encryptedPayload(1000, 0x5E);
+    common::Data plainPayload(100, 0x5F);
+    auto data = createFrame(FrameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::SPECIFIC), FrameSize(encryptedPayload.size()), encryptedPayload);
+    const auto plainFrame = createFrame(FrameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC), FrameSize(plainPayload.size()), plainPayload);
+    data.insert(data.end(), plainFrame.begin(), plainFrame.end());
+
+    std::thread::id decryptThreadId;
+    EXPECT_CALL(cryptorMock_, decryptInto(_, _)).WillOnce(Invoke([&](common::DataBuffer output, const common::DataConstBuffer& buffer) {
+        decryptThreadId = std::this_thread::get_id();
+        std::fill(output.data, output.data + 500, 0x60);
+        return size_t(500);
+    }));
+
+    // the plain message is parsed first, but it came after the encrypted one
     Message::Pointer message;
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
     EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message));
-    frame2PayloadTransportPromise->resolve(frame2Payload);
+    auto receivedTransportPromise = std::move(transportPromise);
+    receivedTransportPromise->resolve(data);
+    this->runUntil([&]() { return message != nullptr; });
 
-    ioService_.run();
+    BOOST_CHECK(decryptThreadId != std::this_thread::get_id());
+    BOOST_CHECK(message->getChannelId() == ChannelId::VIDEO);
+    BOOST_CHECK(message->getPayload() == common::Data(500, 0x60));
+    BOOST_CHECK_EQUAL(cryptoStage->getStatistics().processedJobsCount, 1u);
+
+    auto secondReceivePromise = ReceivePromise::defer(ioService_);
+    ReceivePromiseHandlerMock secondReceivePromiseHandlerMock;
+    secondReceivePromise->then(std::bind(&ReceivePromiseHandlerMock::onResolve, &secondReceivePromiseHandlerMock, std::placeholders::_1),
+                               std::bind(&ReceivePromiseHandlerMock::onReject, &secondReceivePromiseHandlerMock, std::placeholders::_1));
+
+    message.reset();
+    EXPECT_CALL(secondReceivePromiseHandlerMock, onReject(_)).Times(0);
+    EXPECT_CALL(secondReceivePromiseHandlerMock, onResolve(_)).WillOnce(SaveArg<0>(&message));
+    messageInStream->startReceive(std::move(secondReceivePromise));
+    this->runUntil([&]() { return message != nullptr; });
 
     BOOST_CHECK(message->getChannelId() == ChannelId::BLUETOOTH);
-    BOOST_CHECK(message->getEncryptionType() == EncryptionType::PLAIN);
-    BOOST_CHECK(message->getType() == MessageType::SPECIFIC);
+    BOOST_CHECK(message->getPayload() == plainPayload);
+}
 
-    const auto& payload = message->getPayload();
-    BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), expectedPayload.begin(), expectedPayload.end());
+BOOST_FIXTURE_TEST_CASE(MessageInStream_DecryptionFailedOnCryptoStage, MessageInStreamUnitTest)
+{
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_, 16 * 1024 * 1024, std::make_shared<io::PipelineStage>()));
+
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillRepeatedly(SaveArg<0>(&transportPromise));
+
+    messageInStream->startReceive(std::move(receivePromise_));
+    this->runUntil([&]() { return transportPromise != nullptr; });
+
+    common::Data framePayload(1000, 0x5E);
+    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    EXPECT_CALL(cryptorMock_, decryptInto(_, _)).WillOnce(ThrowSSLReadException());
+
+    bool rejected = false;
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(error::Error(error::ErrorCode::SSL_READ, 123))).WillOnce(Invoke([&](const error::Error&) { rejected = true; }));
+    auto receivedTransportPromise = std::move(transportPromise);
+    receivedTransportPromise->resolve(createFrame(frameHeader, FrameSize(framePayload.size()), framePayload));
+    this->runUntil([&]() { return rejected; });
 }
 
-BOOST_FIXTURE_TEST_CASE(MessageInStream_IntertwinedChannels, MessageInStreamUnitTest)
+BOOST_FIXTURE_TEST_CASE(MessageInStream_MessageSizeLimit, MessageInStreamUnitTest)
 {
-    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
-    FrameHeader frame1Header(ChannelId::BLUETOOTH, FrameType::FIRST, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_, 2000));
 
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).Times(2).WillRepeatedly(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
-    common::Data frame1Payload(1000, 0x5E);
-    common::Data frame2Payload(2000, 0x5F);
+    common::Data framePayload(1000, 0x5E);
+    FrameHeader frameHeader(ChannelId::VIDEO, FrameType::FIRST, EncryptionType::PLAIN, MessageType::SPECIFIC);
+
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(error::Error(error::ErrorCode::MESSENGER_MESSAGE_SIZE_LIMIT, 2001)));
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
+    transportPromise->resolve(createFrame(frameHeader, FrameSize(framePayload.size(), 2001), framePayload));
+
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageInStream_ReceiveSeveralMessagesAtOnce, MessageInStreamUnitTest)
+{
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
+
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
-    transport::ITransport::ReceivePromise::Pointer frame1SizeTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameSize::getSizeOf(FrameSizeType::EXTENDED), _)).WillOnce(SaveArg<1>(&frame1SizeTransportPromise));
-    frameHeaderTransportPromise->resolve(frame1Header.getData());
+    messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
-    transport::ITransport::ReceivePromise::Pointer frame1PayloadTransportPromise;
-    EXPECT_CALL(transportMock_, receive(frame1Payload.size(), _)).WillOnce(SaveArg<1>(&frame1PayloadTransportPromise));
-    FrameSize frame1Size(frame1Payload.size(), frame1Payload.size() + frame2Payload.size());
-    frame1SizeTransportPromise->resolve(frame1Size.getData());
+    common::Data message1Payload(10, 0x5E);
+    common::Data message2Payload(20, 0x5F);
+    auto data = createFrame(FrameHeader(ChannelId::INPUT, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC), FrameSize(message1Payload.size()), message1Payload);
+    const auto frame2 = createFrame(FrameHeader(ChannelId::SENSOR, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC), FrameSize(message2Payload.size()), message2Payload);
+    data.insert(data.end(), frame2.begin(), frame2.end());
+
+    Message::Pointer message1;
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&message1));
+    transportPromise->resolve(data);
 
     ioService_.run();
     ioService_.reset();
 
-    frame1PayloadTransportPromise->resolve(frame1Payload);
+    BOOST_CHECK(message1->getChannelId() == ChannelId::INPUT);
+    BOOST_CHECK_EQUAL_COLLECTIONS(message1->getPayload().begin(), message1->getPayload().end(), message1Payload.begin(), message1Payload.end());
+
+    // second message is decoded from the data already received
+    ReceivePromiseHandlerMock secondReceivePromiseHandlerMock;
+    auto secondReceivePromise = ReceivePromise::defer(ioService_);
+    secondReceivePromise->then(std::bind(&ReceivePromiseHandlerMock::onResolve, &secondReceivePromiseHandlerMock, std::placeholders::_1),
+                              std::bind(&ReceivePromiseHandlerMock::onReject, &secondReceivePromiseHandlerMock, std::placeholders::_1));
+
+    Message::Pointer message2;
+    EXPECT_CALL(secondReceivePromiseHandlerMock, onReject(_)).Times(0);
+    EXPECT_CALL(secondReceivePromiseHandlerMock, onResolve(_)).WillOnce(SaveArg<0>(&message2));
+    messageInStream->startReceive(std::move(secondReceivePromise));
+
+    ioService_.run();
+
+    BOOST_CHECK(message2->getChannelId() == ChannelId::SENSOR);
+    BOOST_CHECK_EQUAL_COLLECTIONS(message2->getPayload().begin(), message2->getPayload().end(), message2Payload.begin(), message2Payload.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageInStream_InterleavedChannels, MessageInStreamUnitTest)
+{
+    MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
+
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
+
+    messageInStream->startReceive(std::move(receivePromise_));
 
     ioService_.run();
     ioService_.reset();
 
+    common::Data frame1Payload(1000, 0x5E);
+    common::Data frame2Payload(2000, 0x5F);
+    common::Data expectedPayload(frame1Payload.begin(), frame1Payload.end());
+    expectedPayload.insert(expectedPayload.end(), frame2Payload.begin(), frame2Payload.end());
+    common::Data inputPayload(10, 0x60);
+
+    // input message arrives between the frames of a video message
+    FrameHeader frame1Header(ChannelId::VIDEO, FrameType::FIRST, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    auto data = createFrame(frame1Header, FrameSize(frame1Payload.size(), expectedPayload.size()), frame1Payload);
+    FrameHeader inputFrameHeader(ChannelId::INPUT, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    const auto inputFrame = createFrame(inputFrameHeader, FrameSize(inputPayload.size()), inputPayload);
+    data.insert(data.end(), inputFrame.begin(), inputFrame.end());
     FrameHeader frame2Header(ChannelId::VIDEO, FrameType::LAST, EncryptionType::PLAIN, MessageType::SPECIFIC);
+    const auto frame2 = createFrame(frame2Header, FrameSize(frame2Payload.size()), frame2Payload);
+    data.insert(data.end(), frame2.begin(), frame2.end());
 
-    EXPECT_CALL(receivePromiseHandlerMock_, onReject(error::Error(error::ErrorCode::MESSENGER_INTERTWINED_CHANNELS)));
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
-    frameHeaderTransportPromise->resolve(frame2Header.getData());
+    Message::Pointer inputMessage;
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).WillOnce(SaveArg<0>(&inputMessage));
+    transportPromise->resolve(data);
 
     ioService_.run();
+    ioService_.reset();
+
+    BOOST_CHECK(inputMessage->getChannelId() == ChannelId::INPUT);
+    BOOST_CHECK_EQUAL_COLLECTIONS(inputMessage->getPayload().begin(), inputMessage->getPayload().end(), inputPayload.begin(), inputPayload.end());
+
+    ReceivePromiseHandlerMock secondReceivePromiseHandlerMock;
+    auto secondReceivePromise = ReceivePromise::defer(ioService_);
+    secondReceivePromise->then(std::bind(&ReceivePromiseHandlerMock::onResolve, &secondReceivePromiseHandlerMock, std::placeholders::_1),
+                              std::bind(&ReceivePromiseHandlerMock::onReject, &secondReceivePromiseHandlerMock, std::placeholders::_1));
+
+    Message::Pointer videoMessage;
+    EXPECT_CALL(secondReceivePromiseHandlerMock, onReject(_)).Times(0);
+    EXPECT_CALL(secondReceivePromiseHandlerMock, onResolve(_)).WillOnce(SaveArg<0>(&videoMessage));
+    messageInStream->startReceive(std::move(secondReceivePromise));
+
+    ioService_.run();
+
+    BOOST_CHECK(videoMessage->getChannelId() == ChannelId::VIDEO);
+    BOOST_CHECK_EQUAL_COLLECTIONS(videoMessage->getPayload().begin(), videoMessage->getPayload().end(), expectedPayload.begin(), expectedPayload.end());
 }
 
 BOOST_FIXTURE_TEST_CASE(MessageInStream_RejectWhenInProgress, MessageInStreamUnitTest)
 {
     MessageInStream::Pointer messageInStream(std::make_shared<MessageInStream>(ioService_, transport_, cryptor_));
 
-    FrameHeader frameHeader(ChannelId::BLUETOOTH, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC);
-    transport::ITransport::ReceivePromise::Pointer frameHeaderTransportPromise;
-    EXPECT_CALL(transportMock_, receive(FrameHeader::getSizeOf(), _)).WillOnce(SaveArg<1>(&frameHeaderTransportPromise));
+    transport::ITransport::ReceivePromise::Pointer transportPromise;
+    EXPECT_CALL(transportMock_, receiveAvailable(_)).WillOnce(SaveArg<0>(&transportPromise));
 
     messageInStream->startReceive(std::move(receivePromise_));
 
@@ -16,6 +16,7 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <boost/endian/conversion.hpp>
 #include <f1x/aasdk/IO/PromiseLink.hpp>
 #include <f1x/aasdk/Messenger/MessageOutStream.hpp>
@@ -27,12 +28,11 @@ namespace aasdk
 namespace messenger
 {
 
-MessageOutStream::MessageOutStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor)
+MessageOutStream::MessageOutStream(boost::asio::io_service& ioService, transport::ITransport::Pointer transport, ICryptor::Pointer cryptor, io::PipelineStage::Pointer cryptoStage)
     : strand_(ioService)
     , transport_(std::move(transport))
     , cryptor_(std::move(cryptor))
-    , offset_(0)
-    , remainingSize_(0)
+    , cryptoStage_(std::move(cryptoStage))
 {
 
 }
@@ -40,105 +40,323 @@ MessageOutStream::MessageOutStream(boost::asio::io_service& ioService, transport
 void MessageOutStream::stream(Message::Pointer message, SendPromise::Pointer promise)
 {
     strand_.dispatch([this, self = this->shared_from_this(), message = std::move(message), promise = std::move(promise)]() mutable {
-        if(promise_ != nullptr)
+        // frames of one channel cannot be mixed, the receiver reassembles messages per channel
+        const auto channelId = message->getChannelId();
+        if(std::any_of(splittedMessages_.begin(), splittedMessages_.end(), [&](const auto& splittedMessage) { return splittedMessage.message->getChannelId() == channelId; }))
         {
             promise->reject(error::Error(error::ErrorCode::OPERATION_IN_PROGRESS));
             return;
         }
 
-        message_ = std::move(message);
-        promise_ = std::move(promise);
-
-        if(message_->getPayload().size() >= cMaxFramePayloadSize)
+        if(message->getPayload().size() >= cMaxFramePayloadSize)
         {
-            offset_ = 0;
-            remainingSize_ = message_->getPayload().size();
-            this->streamSplittedMessage();
+            splittedMessages_.push_back(SplittedMessage{std::move(message), std::move(promise), 0});
+
+            if(splittedMessages_.size() == 1)
+            {
+                this->streamSplittedMessage();
+            }
         }
-        else
+        else if(message->getEncryptionType() == EncryptionType::ENCRYPTED)
         {
-            try
-            {
-                auto data(this->compoundFrame(FrameType::BULK, common::DataConstBuffer(message_->getPayload())));
+            // encrypted frames queued during this turn are encrypted together
+            encryptedMessages_.push_back(PendingMessage{std::move(message), std::move(promise)});
 
-                auto transportPromise = transport::ITransport::SendPromise::defer(strand_);
-                io::PromiseLink<>::forward(*transportPromise, std::move(promise_));
-                transport_->send(std::move(data), std::move(transportPromise));
-            }
-            catch(const error::Error& e)
+            if(encryptedMessages_.size() == 1)
             {
-                promise_->reject(e);
-                promise_.reset();
+                strand_.post([this, self = this->shared_from_this()]() {
+                    this->streamEncryptedMessages();
+                });
             }
-
-            this->reset();
+        }
+        else
+        {
+            // single frame goes to the transport right away, also between fragments of splitted messages
+            this->streamSingleFrameMessage(std::move(message), std::move(promise));
         }
     });
 }
 
-void MessageOutStream::streamSplittedMessage()
+void MessageOutStream::streamSingleFrameMessage(Message::Pointer message, SendPromise::Pointer promise)
 {
+    if(cryptoStage_ != nullptr && message->getEncryptionType() == EncryptionType::ENCRYPTED)
+    {
+        auto data = std::make_shared<common::DataSequence>();
+
+        this->postEncryption(
+            [this, message, data]() {
+                *data = this->compoundFrame(message, FrameType::BULK, common::DataConstBuffer(message->getPayload()));
+            },
+            [this, promise, data](const error::Error& e) {
+                if(e != error::ErrorCode::NONE)
+                {
+                    promise->reject(e);
+                }
+                else
+                {
+                    this->sendFrame(std::move(*data), promise);
+                }
+            });
+        return;
+    }
+
     try
     {
-        const auto& payload = message_->getPayload();
-        auto ptr = &payload[offset_];
-        auto size = remainingSize_ < cMaxFramePayloadSize ? remainingSize_ : cMaxFramePayloadSize;
+        auto data(this->hasFrameHeadroom(*message) ? this->compoundFrameInPlace(message)
+                                                   : this->compoundFrame(message, FrameType::BULK, common::DataConstBuffer(message->getPayload())));
+        this->sendFrame(std::move(data), std::move(promise));
+    }
+    catch(const error::Error& e)
+    {
+        promise->reject(e);
+    }
+}
+
+void MessageOutStream::streamEncryptedMessages()
+{
+    std::vector<PendingMessage> encryptedMessages;
+    std::swap(encryptedMessages, encryptedMessages_);
 
-        FrameType frameType = offset_ == 0 ? FrameType::FIRST : (remainingSize_ - size > 0 ? FrameType::MIDDLE : FrameType::LAST);
-        auto data(this->compoundFrame(frameType, common::DataConstBuffer(ptr, size)));
+    if(encryptedMessages.size() == 1)
+    {
+        this->streamSingleFrameMessage(std::move(encryptedMessages.front().message), std::move(encryptedMessages.front().promise));
+        return;
+    }
 
-        auto transportPromise = transport::ITransport::SendPromise::defer(strand_);
+    std::vector<common::Data> frames;
+    std::vector<common::DataConstBuffer> payloadBuffers;
+    frames.reserve(encryptedMessages.size());
+    payloadBuffers.reserve(encryptedMessages.size());
 
-        if(frameType == FrameType::LAST)
+    for(const auto& encryptedMessage : encryptedMessages)
+    {
+        const auto& message = encryptedMessage.message;
+        frames.push_back(FrameHeader(message->getChannelId(), FrameType::BULK, message->getEncryptionType(), message->getType()).getData());
+        frames.back().resize(frames.back().size() + FrameSize::getSizeOf(FrameSizeType::SHORT));
+        payloadBuffers.emplace_back(message->getPayload());
+    }
+
+    if(cryptoStage_ != nullptr)
+    {
+        auto batch = std::make_shared<std::pair<std::vector<common::Data>, std::vector<PendingMessage>>>(std::move(frames), std::move(encryptedMessages));
+
+        this->postEncryption(
+            [this, batch, payloadBuffers = std::move(payloadBuffers)]() {
+                this->encryptFrames(batch->first, payloadBuffers);
+            },
+            [this, batch](const error::Error& e) {
+                for(size_t i = 0; i < batch->second.size(); ++i)
+                {
+                    if(e != error::ErrorCode::NONE)
+                    {
+                        batch->second[i].promise->reject(e);
+                    }
+                    else
+                    {
+                        this->sendFrame(common::DataSequence(std::move(batch->first[i])), std::move(batch->second[i].promise));
+                    }
+                }
+            });
+        return;
+    }
+
+    try
+    {
+        // records have to reach the transport in the order they were encrypted
+        this->encryptFrames(frames, payloadBuffers);
+
+        for(size_t i = 0; i < encryptedMessages.size(); ++i)
         {
-            this->reset();
-            io::PromiseLink<>::forward(*transportPromise, std::move(promise_));
+            this->sendFrame(common::DataSequence(std::move(frames[i])), std::move(encryptedMessages[i].promise));
         }
-        else
+    }
+    catch(const error::Error& e)
+    {
+        for(auto& encryptedMessage : encryptedMessages)
         {
-            transportPromise->then([this, self = this->shared_from_this(), size]() mutable {
-                    offset_ += size;
-                    remainingSize_ -= size;
-                    this->streamSplittedMessage();
-                },
-                [this, self = this->shared_from_this()](const error::Error& e) mutable {
-                    this->reset();
-                    promise_->reject(e);
-                    promise_.reset();
-                });
+            encryptedMessage.promise->reject(e);
         }
+    }
+}
+
+void MessageOutStream::streamSplittedMessage()
+{
+    auto& splittedMessage = splittedMessages_.front();
+    const auto& payload = splittedMessage.message->getPayload();
+    const auto remainingSize = payload.size() - splittedMessage.offset;
+    const size_t maxFramePayloadSize = cMaxFramePayloadSize;
+    const auto size = std::min(remainingSize, maxFramePayloadSize);
+
+    FrameType frameType = splittedMessage.offset == 0 ? FrameType::FIRST : (remainingSize - size > 0 ? FrameType::MIDDLE : FrameType::LAST);
+    const common::DataConstBuffer payloadBuffer(&payload[splittedMessage.offset], size);
 
-        transport_->send(std::move(data), std::move(transportPromise));
+    if(cryptoStage_ != nullptr && splittedMessage.message->getEncryptionType() == EncryptionType::ENCRYPTED)
+    {
+        splittedMessage.offset += size;
+        auto data = std::make_shared<common::DataSequence>();
+
+        // the message stays at the front of the queue until its fragment is sent
+        this->postEncryption(
+            [this, message = splittedMessage.message, frameType, payloadBuffer, data]() {
+                *data = this->compoundFrame(message, frameType, payloadBuffer);
+            },
+            [this, frameType, data](const error::Error& e) {
+                if(e != error::ErrorCode::NONE)
+                {
+                    this->rejectSplittedMessage(e);
+                }
+                else
+                {
+                    this->sendSplittedFrame(frameType, std::move(*data));
+                }
+            });
+        return;
+    }
+
+    try
+    {
+        auto data(this->compoundFrame(splittedMessage.message, frameType, payloadBuffer));
+        splittedMessage.offset += size;
+        this->sendSplittedFrame(frameType, std::move(data));
     }
     catch(const error::Error& e)
     {
-        this->reset();
-        promise_->reject(e);
-        promise_.reset();
+        this->rejectSplittedMessage(e);
     }
 }
 
-common::Data MessageOutStream::compoundFrame(FrameType frameType, const common::DataConstBuffer& payloadBuffer)
+void MessageOutStream::sendFrame(common::DataSequence data, SendPromise::Pointer promise)
 {
-    const FrameHeader frameHeader(message_->getChannelId(), frameType, message_->getEncryptionType(), message_->getType());
-    common::Data data(frameHeader.getData());
-    data.resize(data.size() + FrameSize::getSizeOf(frameType == FrameType::FIRST ? FrameSizeType::EXTENDED : FrameSizeType::SHORT));
+    auto transportPromise = transport::ITransport::SendPromise::defer(strand_);
+    io::PromiseLink<>::forward(*transportPromise, std::move(promise));
+    transport_->send(std::move(data), std::move(transportPromise));
+}
+
+void MessageOutStream::sendSplittedFrame(FrameType frameType, common::DataSequence data)
+{
+    auto transportPromise = transport::ITransport::SendPromise::defer(strand_);
+    transportPromise->then([this, self = this->shared_from_this(), frameType]() mutable {
+            auto splittedMessage(std::move(splittedMessages_.front()));
+            splittedMessages_.pop_front();
+
+            if(frameType == FrameType::LAST)
+            {
+                splittedMessage.promise->resolve();
+            }
+            else
+            {
+                // yield to other splitted messages before the next fragment
+                splittedMessages_.push_back(std::move(splittedMessage));
+            }
+
+            if(!splittedMessages_.empty())
+            {
+                this->streamSplittedMessage();
+            }
+        },
+        std::bind(&MessageOutStream::rejectSplittedMessages, this->shared_from_this(), std::placeholders::_1));
+
+    transport_->send(std::move(data), std::move(transportPromise));
+}
+
+void MessageOutStream::rejectSplittedMessage(const error::Error& e)
+{
+    auto splittedMessage(std::move(splittedMessages_.front()));
+    splittedMessages_.pop_front();
+    splittedMessage.promise->reject(e);
+
+    if(!splittedMessages_.empty())
+    {
+        this->streamSplittedMessage();
+    }
+}
+
+void MessageOutStream::rejectSplittedMessages(const error::Error& e)
+{
+    while(!splittedMessages_.empty())
+    {
+        auto splittedMessage(std::move(splittedMessages_.front()));
+        splittedMessages_.pop_front();
+        splittedMessage.promise->reject(e);
+    }
+}
+
+void MessageOutStream::postEncryption(std::function<void()> encryption, std::function<void(const error::Error&)> handler)
+{
+    // the stage runs encryptions one at a time, so handlers get back to the strand in the order the records were encrypted
+    cryptoStage_->post([this, self = this->shared_from_this(), encryption = std::move(encryption), handler = std::move(handler)]() mutable {
+        error::Error error;
+
+        try
+        {
+            encryption();
+        }
+        catch(const error::Error& e)
+        {
+            error = e;
+        }
+
+        // everything the job holds is released on the strand
+        strand_.post([self = std::move(self), encryption = std::move(encryption), handler = std::move(handler), error]() mutable {
+            handler(error);
+        });
+    });
+}
+
+void MessageOutStream::encryptFrames(std::vector<common::Data>& frames, const std::vector<common::DataConstBuffer>& payloadBuffers)
+{
+    const auto payloadSizes = cryptor_->encryptBatch(frames, payloadBuffers);
+
+    for(size_t i = 0; i < frames.size(); ++i)
+    {
+        this->setFrameSize(frames[i], FrameType::BULK, payloadSizes[i], payloadSizes[i]);
+    }
+}
+
+common::DataSequence MessageOutStream::compoundFrame(const Message::Pointer& message, FrameType frameType, const common::DataConstBuffer& payloadBuffer)
+{
+    const FrameHeader frameHeader(message->getChannelId(), frameType, message->getEncryptionType(), message->getType());
+    common::DataSequence data(frameHeader.getData());
+    data.head.resize(data.head.size() + FrameSize::getSizeOf(frameType == FrameType::FIRST ? FrameSizeType::EXTENDED : FrameSizeType::SHORT));
     size_t payloadSize = 0;
 
-    if(message_->getEncryptionType() == EncryptionType::ENCRYPTED)
+    if(message->getEncryptionType() == EncryptionType::ENCRYPTED)
     {
-        payloadSize = cryptor_->encrypt(data, payloadBuffer);
+        payloadSize = cryptor_->encrypt(data.head, payloadBuffer);
     }
     else
     {
-        data.insert(data.end(), payloadBuffer.cdata, payloadBuffer.cdata + payloadBuffer.size);
+        // plain payload is sent straight from the message, which stays alive until the transport is done with it
+        data.payload = common::DataSlice(message, payloadBuffer);
         payloadSize = payloadBuffer.size;
     }
 
-    this->setFrameSize(data, frameType, payloadSize, message_->getPayload().size());
+    this->setFrameSize(data.head, frameType, payloadSize, message->getPayload().size());
     return data;
 }
 
+bool MessageOutStream::hasFrameHeadroom(const Message& message) const
+{
+    const auto& payload = message.getPayload();
+    return message.getEncryptionType() == EncryptionType::PLAIN && payload.data() != nullptr
+           && payload.get_allocator().getHeadroom() >= FrameHeader::getSizeOf() + FrameSize::getSizeOf(FrameSizeType::SHORT);
+}
+
+common::DataSequence MessageOutStream::compoundFrameInPlace(const Message::Pointer& message)
+{
+    // frame header and size go to the headroom of the payload, the frame is sent straight from the message
+    auto& payload = message->getPayload();
+    const auto frameHeaderData = FrameHeader(message->getChannelId(), FrameType::BULK, message->getEncryptionType(), message->getType()).getData();
+    const auto frameSizeData = FrameSize(payload.size()).getData();
+
+    auto frame = payload.data() - frameHeaderData.size() - frameSizeData.size();
+    std::copy(frameHeaderData.begin(), frameHeaderData.end(), frame);
+    std::copy(frameSizeData.begin(), frameSizeData.end(), frame + frameHeaderData.size());
+
+    const common::DataConstBuffer frameBuffer(frame, frameHeaderData.size() + frameSizeData.size() + payload.size());
+    return common::DataSequence(common::Data(), common::DataSlice(message, frameBuffer));
+}
+
 void MessageOutStream::setFrameSize(common::Data& data, FrameType frameType, size_t payloadSize, size_t totalSize)
 {
     const auto& frameSize = frameType == FrameType::FIRST ? FrameSize(payloadSize, totalSize) : FrameSize(payloadSize);
@@ -146,13 +364,6 @@ void MessageOutStream::setFrameSize(common::Data& data, FrameType frameType, siz
     memcpy(&data[FrameHeader::getSizeOf()], &frameSizeData[0], frameSizeData.size());
 }
 
-void MessageOutStream::reset()
-{
-    offset_ = 0;
-    remainingSize_ = 0;
-    message_.reset();
-}
-
 }
 }
 }
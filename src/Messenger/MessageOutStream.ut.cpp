@@ -16,6 +16,7 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <thread>
 #include <boost/test/unit_test.hpp>
 #include <f1x/aasdk/Transport/UT/Transport.mock.hpp>
 #include <f1x/aasdk/Messenger/UT/Cryptor.mock.hpp>
@@ -34,8 +35,10 @@ namespace ut
 
 using ::testing::_;
 using ::testing::SaveArg;
+using ::testing::Eq;
 using ::testing::SetArgReferee;
 using ::testing::Return;
+using ::testing::Invoke;
 
 class MessageOutStreamUnitTest
 {
@@ -49,6 +52,17 @@ protected:
                           std::bind(&SendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
     }
 
+    // handlers of a crypto stage get back to the io_service from another thread
+    void runUntil(const std::function<bool()>& condition)
+    {
+        while(!condition())
+        {
+            ioService_.poll();
+            ioService_.reset();
+            std::this_thread::yield();
+        }
+    }
+
     boost::asio::io_service ioService_;
     transport::ut::TransportMock transportMock_;
     transport::ITransport::Pointer transport_;
@@ -77,7 +91,7 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendPlainMessage, MessageOutStreamUnitT
     expectedData.insert(expectedData.end(), payload.begin(), payload.end());
 
     transport::ITransport::SendPromise::Pointer transportSendPromise;
-    EXPECT_CALL(transportMock_, send(expectedData, _)).WillOnce(SaveArg<1>(&transportSendPromise));
+    EXPECT_CALL(transportMock_, send(Eq(expectedData), _)).WillOnce(SaveArg<1>(&transportSendPromise));
 
     Message::Pointer message(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::PLAIN, MessageType::CONTROL));
     message->insertPayload(payload);
@@ -93,6 +107,36 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendPlainMessage, MessageOutStreamUnitT
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendPlainMessageInPlace, MessageOutStreamUnitTest)
+{
+    Message::Pointer message(std::make_shared<Message>(ChannelId::SENSOR, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    message->insertPayload(common::Data(100, 0x5E));
+
+    common::DataSequence data;
+    transport::ITransport::SendPromise::Pointer transportSendPromise;
+    EXPECT_CALL(transportMock_, send(_, _)).WillOnce(DoAll(SaveArg<0>(&data), SaveArg<1>(&transportSendPromise)));
+
+    MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_));
+    messageOutStream->stream(message, std::move(sendPromise_));
+
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_CHECK(data.head.empty());
+    BOOST_CHECK(data.payload.cdata == message->getPayload().data() - Message::cPayloadHeadroomSize);
+
+    common::Data expectedData(FrameHeader(ChannelId::SENSOR, FrameType::BULK, EncryptionType::PLAIN, MessageType::SPECIFIC).getData());
+    const auto frameSizeData = FrameSize(100).getData();
+    expectedData.insert(expectedData.end(), frameSizeData.begin(), frameSizeData.end());
+    expectedData.insert(expectedData.end(), 100, 0x5E);
+    BOOST_CHECK(data == expectedData);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    transportSendPromise->resolve();
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendEncryptedMessage, MessageOutStreamUnitTest)
 {
     const FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
@@ -110,7 +154,7 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendEncryptedMessage, MessageOutStreamU
     encryptedData.insert(encryptedData.end(), encryptedPayload.begin(), encryptedPayload.end());
     transport::ITransport::SendPromise::Pointer transportSendPromise;
     EXPECT_CALL(cryptorMock_, encrypt(_, _)).WillOnce(DoAll(SetArgReferee<0>(encryptedData), Return(encryptedPayload.size())));
-    EXPECT_CALL(transportMock_, send(expectedData, _)).WillOnce(SaveArg<1>(&transportSendPromise));
+    EXPECT_CALL(transportMock_, send(Eq(expectedData), _)).WillOnce(SaveArg<1>(&transportSendPromise));
 
     Message::Pointer message(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::CONTROL));
     const common::Data payload(1000, 0x5E);
@@ -142,6 +186,173 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_MessageEncryptionFailed, MessageOutStre
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(MessageOutStream_EncryptMessageOnCryptoStage, MessageOutStreamUnitTest)
+{
+    const FrameHeader frameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL);
+    const common::Data encryptedPayload(2000, 0x5F);
+    const FrameSize frameSize(encryptedPayload.size());
+
+    const auto& frameHeaderData = frameHeader.getData();
+    common::Data expectedData(frameHeaderData.begin(), frameHeaderData.end());
+
+    const auto& frameSizeData = frameSize.getData();
+    expectedData.insert(expectedData.end(), frameSizeData.begin(), frameSizeData.end());
+    expectedData.insert(expectedData.end(), encryptedPayload.begin(), encryptedPayload.end());
+
+    common::Data encryptedData(expectedData.begin(), expectedData.begin() + FrameHeader::getSizeOf() + FrameSize::getSizeOf(FrameSizeType::SHORT));
+    encryptedData.insert(encryptedData.end(), encryptedPayload.begin(), encryptedPayload.end());
+
+    std::thread::id encryptThreadId;
+    EXPECT_CALL(cryptorMock_, encrypt(_, _)).WillOnce(Invoke([&](common::Data& output, const common::DataConstBuffer&) {
+        encryptThreadId = std::this_thread::get_id();
+        output = encryptedData;
+        return encryptedPayload.size();
+    }));
+
+    transport::ITransport::SendPromise::Pointer transportSendPromise;
+    EXPECT_CALL(transportMock_, send(Eq(expectedData), _)).WillOnce(SaveArg<1>(&transportSendPromise));
+
+    Message::Pointer message(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::CONTROL));
+    message->insertPayload(common::Data(1000, 0x5E));
+    auto cryptoStage = std::make_shared<io::PipelineStage>();
+    MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_, cryptoStage));
+    messageOutStream->stream(message, std::move(sendPromise_));
+
+    this->runUntil([&]() { return transportSendPromise != nullptr; });
+    BOOST_CHECK(encryptThreadId != std::this_thread::get_id());
+    BOOST_CHECK_EQUAL(cryptoStage->getStatistics().processedJobsCount, 1u);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    transportSendPromise->resolve();
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageOutStream_EncryptSplittedMessageOnCryptoStage, MessageOutStreamUnitTest)
+{
+    const size_t maxFramePayloadSize = 0x4000;
+
+    Message::Pointer message(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::CONTROL));
+    message->insertPayload(common::Data(maxFramePayloadSize, 0x5E));
+    message->insertPayload(common::Data(maxFramePayloadSize, 0x5F));
+
+    // every fragment is encrypted on the stage, in the order of the message
+    std::vector<uint8_t> encryptedFragments;
+    EXPECT_CALL(cryptorMock_, encrypt(_, _)).Times(2).WillRepeatedly(Invoke([&](common::Data& output, const common::DataConstBuffer& buffer) {
+        encryptedFragments.push_back(buffer.cdata[0]);
+        output.insert(output.end(), 100, buffer.cdata[0]);
+        return size_t(100);
+    }));
+
+    std::vector<common::Data> frames;
+    transport::ITransport::SendPromise::Pointer transportSendPromise;
+    EXPECT_CALL(transportMock_, send(_, _)).Times(2).WillRepeatedly(Invoke([&](common::DataSequence data, transport::ITransport::SendPromise::Pointer promise) {
+        frames.push_back(data.head);
+        transportSendPromise = std::move(promise);
+    }));
+
+    MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_, std::make_shared<io::PipelineStage>()));
+    messageOutStream->stream(message, std::move(sendPromise_));
+
+    this->runUntil([&]() { return frames.size() == 1; });
+    transportSendPromise->resolve();
+    this->runUntil([&]() { return frames.size() == 2; });
+
+    BOOST_CHECK(encryptedFragments == std::vector<uint8_t>({0x5E, 0x5F}));
+    BOOST_CHECK(FrameHeader(common::DataConstBuffer(frames[0])).getType() == FrameType::FIRST);
+    BOOST_CHECK_EQUAL(FrameSize(common::DataConstBuffer(frames[0], FrameHeader::getSizeOf())).getTotalSize(), 2 * maxFramePayloadSize);
+    BOOST_CHECK(FrameHeader(common::DataConstBuffer(frames[1])).getType() == FrameType::LAST);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    transportSendPromise->resolve();
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendEncryptedMessagesInBatch, MessageOutStreamUnitTest)
+{
+    const common::Data encryptedPayload(2000, 0x5F);
+    const FrameSize frameSize(encryptedPayload.size());
+
+    const auto& videoFrameHeaderData = FrameHeader(ChannelId::VIDEO, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::CONTROL).getData();
+    const auto& inputFrameHeaderData = FrameHeader(ChannelId::INPUT, FrameType::BULK, EncryptionType::ENCRYPTED, MessageType::SPECIFIC).getData();
+    const auto& frameSizeData = frameSize.getData();
+
+    common::Data expectedVideoData(videoFrameHeaderData.begin(), videoFrameHeaderData.end());
+    expectedVideoData.insert(expectedVideoData.end(), frameSizeData.begin(), frameSizeData.end());
+    expectedVideoData.insert(expectedVideoData.end(), encryptedPayload.begin(), encryptedPayload.end());
+
+    common::Data expectedInputData(inputFrameHeaderData.begin(), inputFrameHeaderData.end());
+    expectedInputData.insert(expectedInputData.end(), frameSizeData.begin(), frameSizeData.end());
+    expectedInputData.insert(expectedInputData.end(), encryptedPayload.begin(), encryptedPayload.end());
+
+    EXPECT_CALL(cryptorMock_, encrypt(_, _)).Times(0);
+    EXPECT_CALL(cryptorMock_, encryptBatch(_, _)).WillOnce(Invoke([&](std::vector<common::Data>& outputs, const std::vector<common::DataConstBuffer>& buffers) {
+        BOOST_CHECK_EQUAL(buffers.size(), 2);
+        BOOST_CHECK_EQUAL(buffers[0].size, 1000);
+        BOOST_CHECK_EQUAL(buffers[1].size, 100);
+
+        for(auto& output : outputs)
+        {
+            output.insert(output.end(), encryptedPayload.begin(), encryptedPayload.end());
+        }
+
+        return std::vector<size_t>(outputs.size(), encryptedPayload.size());
+    }));
+
+    transport::ITransport::SendPromise::Pointer videoSendPromise;
+    transport::ITransport::SendPromise::Pointer inputSendPromise;
+    ::testing::InSequence sequence;
+    EXPECT_CALL(transportMock_, send(Eq(expectedVideoData), _)).WillOnce(SaveArg<1>(&videoSendPromise));
+    EXPECT_CALL(transportMock_, send(Eq(expectedInputData), _)).WillOnce(SaveArg<1>(&inputSendPromise));
+
+    MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_));
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::CONTROL));
+    videoMessage->insertPayload(common::Data(1000, 0x5E));
+    messageOutStream->stream(videoMessage, std::move(sendPromise_));
+
+    SendPromiseHandlerMock inputSendPromiseHandlerMock;
+    auto inputPromise = SendPromise::defer(ioService_);
+    inputPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &inputSendPromiseHandlerMock),
+                       std::bind(&SendPromiseHandlerMock::onReject, &inputSendPromiseHandlerMock, std::placeholders::_1));
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    inputMessage->insertPayload(common::Data(100, 0x5D));
+    messageOutStream->stream(inputMessage, std::move(inputPromise));
+
+    ioService_.run();
+    ioService_.reset();
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    EXPECT_CALL(inputSendPromiseHandlerMock, onResolve());
+    videoSendPromise->resolve();
+    inputSendPromise->resolve();
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(MessageOutStream_BatchEncryptionFailed, MessageOutStreamUnitTest)
+{
+    MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_));
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::CONTROL));
+    videoMessage->insertPayload(common::Data(1000, 0x5E));
+    messageOutStream->stream(videoMessage, std::move(sendPromise_));
+
+    SendPromiseHandlerMock inputSendPromiseHandlerMock;
+    auto inputPromise = SendPromise::defer(ioService_);
+    inputPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &inputSendPromiseHandlerMock),
+                       std::bind(&SendPromiseHandlerMock::onReject, &inputSendPromiseHandlerMock, std::placeholders::_1));
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    inputMessage->insertPayload(common::Data(100, 0x5D));
+    messageOutStream->stream(inputMessage, std::move(inputPromise));
+
+    EXPECT_CALL(cryptorMock_, encryptBatch(_, _)).WillOnce(ThrowSSLWriteException());
+    EXPECT_CALL(transportMock_, send(_, _)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(error::Error(error::ErrorCode::SSL_WRITE, 32)));
+    EXPECT_CALL(inputSendPromiseHandlerMock, onReject(error::Error(error::ErrorCode::SSL_WRITE, 32)));
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendError, MessageOutStreamUnitTest)
 {
     Message::Pointer message(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::PLAIN, MessageType::CONTROL));
@@ -191,7 +402,7 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendSplittedMessage, MessageOutStreamUn
     common::Data expectedData1(frame1HeaderData.begin(), frame1HeaderData.end());
     expectedData1.insert(expectedData1.end(), frame1SizeData.begin(), frame1SizeData.end());
     expectedData1.insert(expectedData1.end(), frame1Payload.begin(), frame1Payload.end());
-    EXPECT_CALL(transportMock_, send(expectedData1, _)).WillOnce(SaveArg<1>(&transportSendPromise));
+    EXPECT_CALL(transportMock_, send(Eq(expectedData1), _)).WillOnce(SaveArg<1>(&transportSendPromise));
 
     MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_));
     messageOutStream->stream(message, std::move(sendPromise_));
@@ -202,7 +413,7 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendSplittedMessage, MessageOutStreamUn
     common::Data expectedData2(frame2HeaderData.begin(), frame2HeaderData.end());
     expectedData2.insert(expectedData2.end(), frame2SizeData.begin(), frame2SizeData.end());
     expectedData2.insert(expectedData2.end(), frame2Payload.begin(), frame2Payload.end());
-    EXPECT_CALL(transportMock_, send(expectedData2, _)).WillOnce(SaveArg<1>(&transportSendPromise));
+    EXPECT_CALL(transportMock_, send(Eq(expectedData2), _)).WillOnce(SaveArg<1>(&transportSendPromise));
 
     auto secondSendPromise = SendPromise::defer(ioService_);
     SendPromiseHandlerMock secondSendPromiseHandlerMock;
@@ -223,6 +434,66 @@ BOOST_FIXTURE_TEST_CASE(MessageOutStream_SendSplittedMessage, MessageOutStreamUn
     ioService_.run();
 }
 
+
+BOOST_FIXTURE_TEST_CASE(MessageOutStream_InterleaveSplittedMessages, MessageOutStreamUnitTest)
+{
+    const size_t maxFramePayloadSize = 0x4000;
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    videoMessage->insertPayload(common::Data(maxFramePayloadSize * 2, 0x5E));
+
+    Message::Pointer audioMessage(std::make_shared<Message>(ChannelId::MEDIA_AUDIO, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    audioMessage->insertPayload(common::Data(maxFramePayloadSize * 2, 0x5F));
+
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    inputMessage->insertPayload(common::Data(100, 0x60));
+
+    std::vector<std::pair<ChannelId, FrameType>> frames;
+    std::vector<transport::ITransport::SendPromise::Pointer> transportSendPromises;
+    EXPECT_CALL(transportMock_, send(_, _)).Times(5).WillRepeatedly(Invoke([&](common::DataSequence data, transport::ITransport::SendPromise::Pointer promise) {
+        const FrameHeader frameHeader(data.head.empty() ? common::DataConstBuffer(data.payload) : common::DataConstBuffer(data.head));
+        frames.emplace_back(frameHeader.getChannelId(), frameHeader.getType());
+        transportSendPromises.push_back(std::move(promise));
+    }));
+
+    auto audioSendPromise = SendPromise::defer(ioService_);
+    audioSendPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock_),
+                           std::bind(&SendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
+
+    auto inputSendPromise = SendPromise::defer(ioService_);
+    inputSendPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock_),
+                           std::bind(&SendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
+
+    MessageOutStream::Pointer messageOutStream(std::make_shared<MessageOutStream>(ioService_, transport_, cryptor_));
+    messageOutStream->stream(videoMessage, std::move(sendPromise_));
+    messageOutStream->stream(audioMessage, std::move(audioSendPromise));
+    messageOutStream->stream(inputMessage, std::move(inputSendPromise));
+
+    ioService_.run();
+    ioService_.reset();
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(3);
+
+    for(size_t i = 0; i < 5; ++i)
+    {
+        BOOST_REQUIRE(i < transportSendPromises.size());
+        transportSendPromises[i]->resolve();
+        ioService_.run();
+        ioService_.reset();
+    }
+
+    const std::vector<std::pair<ChannelId, FrameType>> expectedFrames{
+        {ChannelId::VIDEO, FrameType::FIRST},
+        {ChannelId::INPUT, FrameType::BULK},
+        {ChannelId::MEDIA_AUDIO, FrameType::FIRST},
+        {ChannelId::VIDEO, FrameType::LAST},
+        {ChannelId::MEDIA_AUDIO, FrameType::LAST}
+    };
+
+    BOOST_CHECK(frames == expectedFrames);
+}
+
 }
 }
 }
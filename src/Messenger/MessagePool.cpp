@@ -0,0 +1,124 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <mutex>
+#include <vector>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+namespace
+{
+
+struct FreeMessages
+{
+    std::mutex mutex;
+    std::vector<Message*> messages;
+    size_t payloadSize = 0;
+};
+
+FreeMessages& getFreeMessages()
+{
+    // never destroyed, messages may still be released by other static objects at exit
+    static auto freeMessages = new FreeMessages();
+    return *freeMessages;
+}
+
+}
+
+std::atomic<uint64_t> MessagePool::poolAllocations_(0);
+std::atomic<uint64_t> MessagePool::heapAllocations_(0);
+std::atomic<uint64_t> MessagePool::recycledMessages_(0);
+
+Message::Pointer MessagePool::create(ChannelId channelId, EncryptionType encryptionType, MessageType type)
+{
+    Message* message = nullptr;
+
+    {
+        auto& freeMessages = getFreeMessages();
+        std::lock_guard<std::mutex> lock(freeMessages.mutex);
+
+        if(!freeMessages.messages.empty())
+        {
+            message = freeMessages.messages.back();
+            freeMessages.messages.pop_back();
+            freeMessages.payloadSize -= message->getPayload().capacity();
+        }
+    }
+
+    if(message != nullptr)
+    {
+        poolAllocations_.fetch_add(1, std::memory_order_relaxed);
+        message->reset(channelId, encryptionType, type);
+    }
+    else
+    {
+        heapAllocations_.fetch_add(1, std::memory_order_relaxed);
+        message = new Message(channelId, encryptionType, type);
+    }
+
+    return Message::Pointer(message, &MessagePool::recycle, common::DataAllocator<Message>());
+}
+
+MessagePool::Statistics MessagePool::getStatistics()
+{
+    auto& freeMessages = getFreeMessages();
+    std::lock_guard<std::mutex> lock(freeMessages.mutex);
+
+    return {poolAllocations_.load(std::memory_order_relaxed),
+            heapAllocations_.load(std::memory_order_relaxed),
+            recycledMessages_.load(std::memory_order_relaxed),
+            freeMessages.payloadSize};
+}
+
+void MessagePool::resetStatistics()
+{
+    poolAllocations_.store(0, std::memory_order_relaxed);
+    heapAllocations_.store(0, std::memory_order_relaxed);
+    recycledMessages_.store(0, std::memory_order_relaxed);
+}
+
+void MessagePool::recycle(Message* message)
+{
+    const auto payloadCapacity = message->getPayload().capacity();
+
+    if(payloadCapacity <= cMaxPooledPayloadCapacity)
+    {
+        auto& freeMessages = getFreeMessages();
+        std::lock_guard<std::mutex> lock(freeMessages.mutex);
+
+        if(freeMessages.messages.size() < cMaxPooledMessagesCount && freeMessages.payloadSize + payloadCapacity <= cMaxPooledPayloadSize)
+        {
+            freeMessages.messages.push_back(message);
+            freeMessages.payloadSize += payloadCapacity;
+            recycledMessages_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    delete message;
+}
+
+}
+}
+}
@@ -0,0 +1,90 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/Messenger/MessagePool.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+namespace ut
+{
+
+BOOST_AUTO_TEST_CASE(MessagePool_RecycleMessage)
+{
+    auto message = MessagePool::create(ChannelId::SENSOR, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    message->insertPayload(common::Data(1000, 0x5E));
+
+    const auto rawMessage = message.get();
+    const auto payloadData = message->getPayload().data();
+    message.reset();
+
+    MessagePool::resetStatistics();
+    message = MessagePool::create(ChannelId::INPUT, EncryptionType::PLAIN, MessageType::CONTROL);
+
+    BOOST_CHECK(message.get() == rawMessage);
+    BOOST_CHECK(message->getChannelId() == ChannelId::INPUT);
+    BOOST_CHECK(message->getEncryptionType() == EncryptionType::PLAIN);
+    BOOST_CHECK(message->getType() == MessageType::CONTROL);
+    BOOST_CHECK(message->getPayload().empty());
+    BOOST_CHECK(message->getPayload().capacity() >= 1000);
+
+    message->insertPayload(common::Data(500, 0x5F));
+    BOOST_CHECK(message->getPayload().data() == payloadData);
+
+    const auto statistics = MessagePool::getStatistics();
+    BOOST_CHECK_EQUAL(statistics.poolAllocations, 1u);
+    BOOST_CHECK_EQUAL(statistics.heapAllocations, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(MessagePool_DoNotKeepBigPayloads)
+{
+    auto message = MessagePool::create(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC);
+    message->insertPayload(common::Data(1024 * 1024, 0x5E));
+
+    MessagePool::resetStatistics();
+    message.reset();
+
+    BOOST_CHECK_EQUAL(MessagePool::getStatistics().recycledMessages, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(MessagePool_LimitPooledPayloadSize)
+{
+    std::vector<Message::Pointer> messages;
+
+    for(size_t i = 0; i < 64; ++i)
+    {
+        messages.push_back(MessagePool::create(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+        messages.back()->insertPayload(common::Data(60 * 1024, 0x5E));
+    }
+
+    MessagePool::resetStatistics();
+    messages.clear();
+
+    const auto statistics = MessagePool::getStatistics();
+    BOOST_CHECK(statistics.recycledMessages < 64u);
+    BOOST_CHECK(statistics.pooledPayloadSize <= 1024u * 1024u);
+}
+
+}
+}
+}
+}
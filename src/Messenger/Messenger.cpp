@@ -16,6 +16,7 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <boost/endian/conversion.hpp>
 #include <f1x/aasdk/Error/Error.hpp>
 #include <f1x/aasdk/Messenger/Messenger.hpp>
@@ -32,6 +33,8 @@ Messenger::Messenger(boost::asio::io_service& ioService, IMessageInStream::Point
     , sendStrand_(ioService)
     , messageInStream_(std::move(messageInStream))
     , messageOutStream_(std::move(messageOutStream))
+    , receiving_(false)
+    , sendWindow_(cDefaultSendWindow)
 {
 
 }
@@ -46,35 +49,38 @@ void Messenger::enqueueReceive(ChannelId channelId, ReceivePromise::Pointer prom
         else
         {
             channelReceivePromiseQueue_.push(channelId, std::move(promise));
-
-            if(channelReceivePromiseQueue_.size() == 1)
-            {
-                auto inStreamPromise = ReceivePromise::defer(receiveStrand_);
-                inStreamPromise->then(std::bind(&Messenger::inStreamMessageHandler, this->shared_from_this(), std::placeholders::_1),
-                                     std::bind(&Messenger::rejectReceivePromiseQueue, this->shared_from_this(), std::placeholders::_1));
-                messageInStream_->startReceive(std::move(inStreamPromise));
-            }
         }
+
+        this->startReceive();
     });
 }
 
 void Messenger::enqueueSend(Message::Pointer message, SendPromise::Pointer promise)
 {
     sendStrand_.dispatch([this, self = this->shared_from_this(), message = std::move(message), promise = std::move(promise)]() mutable {
-        channelSendPromiseQueue_.emplace_back(std::make_pair(std::move(message), std::move(promise)));
-
-        if(channelSendPromiseQueue_.size() == 1)
-        {
-            this->doSend();
-        }
+        channelSendPromiseQueue_.push(std::move(message), std::move(promise));
+        this->doSend();
     });
 }
 
 void Messenger::inStreamMessageHandler(Message::Pointer message)
 {
     auto channelId = message->getChannelId();
+    auto channelReceiveRing = channelReceiveRings_.find(channelId);
 
-    if(channelReceivePromiseQueue_.isPending(channelId))
+    if(channelReceiveRing != channelReceiveRings_.end())
+    {
+        if(fullReceiveRings_.count(channelId) == 0 && !channelReceiveRing->second->full())
+        {
+            channelReceiveRing->second->push(std::move(message));
+        }
+        else
+        {
+            channelReceiveMessageQueue_.push(std::move(message));
+            this->fillReceiveRing(channelId);
+        }
+    }
+    else if(channelReceivePromiseQueue_.isPending(channelId))
     {
         channelReceivePromiseQueue_.pop(channelId)->resolve(std::move(message));
     }
@@ -83,8 +89,18 @@ void Messenger::inStreamMessageHandler(Message::Pointer message)
         channelReceiveMessageQueue_.push(std::move(message));
     }
 
-    if(!channelReceivePromiseQueue_.empty())
+    receiving_ = false;
+    this->startReceive();
+}
+
+void Messenger::startReceive()
+{
+    // a full ring or a full queue of a channel with the blocking policy stops reading until the application drains it
+    if(!receiving_ && (!channelReceivePromiseQueue_.empty() || !channelReceiveRings_.empty())
+       && fullReceiveRings_.empty() && !channelReceiveMessageQueue_.blocked())
     {
+        receiving_ = true;
+
         auto inStreamPromise = ReceivePromise::defer(receiveStrand_);
         inStreamPromise->then(std::bind(&Messenger::inStreamMessageHandler, this->shared_from_this(), std::placeholders::_1),
                              std::bind(&Messenger::rejectReceivePromiseQueue, this->shared_from_this(), std::placeholders::_1));
@@ -94,47 +110,184 @@ void Messenger::inStreamMessageHandler(Message::Pointer message)
 
 void Messenger::doSend()
 {
-    auto queueElementIter = channelSendPromiseQueue_.begin();
-    auto outStreamPromise = SendPromise::defer(sendStrand_);
-    outStreamPromise->then(std::bind(&Messenger::outStreamMessageHandler, this->shared_from_this(), queueElementIter),
-                           std::bind(&Messenger::rejectSendPromiseQueue, this->shared_from_this(), std::placeholders::_1));
+    while((sendPromises_.size() < sendWindow_ && channelSendPromiseQueue_.ready())
+          || (sendPromises_.size() == sendWindow_ && channelSendPromiseQueue_.readyAtTopPriority()))
+    {
+        auto queueElement = channelSendPromiseQueue_.pop();
+        const auto channelId = queueElement.first->getChannelId();
+        sendPromises_[channelId] = std::move(queueElement.second);
+
+        auto outStreamPromise = SendPromise::defer(sendStrand_);
+        outStreamPromise->then(std::bind(&Messenger::outStreamMessageHandler, this->shared_from_this(), channelId),
+                               std::bind(&Messenger::rejectSendPromiseQueue, this->shared_from_this(), std::placeholders::_1));
 
-    messageOutStream_->stream(std::move(queueElementIter->first), std::move(outStreamPromise));
+        messageOutStream_->stream(std::move(queueElement.first), std::move(outStreamPromise));
+    }
 }
 
-void Messenger::outStreamMessageHandler(ChannelSendQueue::iterator queueElement)
+void Messenger::outStreamMessageHandler(ChannelId channelId)
 {
-    queueElement->second->resolve();
-    channelSendPromiseQueue_.erase(queueElement);
+    auto sendPromise = sendPromises_.find(channelId);
 
-    if(!channelSendPromiseQueue_.empty())
+    if(sendPromise != sendPromises_.end())
     {
-        this->doSend();
+        sendPromise->second->resolve();
+        sendPromises_.erase(sendPromise);
+        channelSendPromiseQueue_.release(channelId);
     }
+
+    this->doSend();
 }
 
 void Messenger::rejectReceivePromiseQueue(const error::Error& e)
 {
+    receiving_ = false;
+
     while(!channelReceivePromiseQueue_.empty())
     {
         channelReceivePromiseQueue_.pop()->reject(e);
     }
+
+    this->closeReceiveRings(e);
+}
+
+void Messenger::closeReceiveRings(const error::Error& e)
+{
+    for(auto& channelReceiveRing : channelReceiveRings_)
+    {
+        channelReceiveRing.second->close(e);
+    }
+
+    channelReceiveRings_.clear();
+    fullReceiveRings_.clear();
+}
+
+void Messenger::fillReceiveRing(ChannelId channelId)
+{
+    auto channelReceiveRing = channelReceiveRings_.find(channelId);
+
+    if(channelReceiveRing == channelReceiveRings_.end())
+    {
+        fullReceiveRings_.erase(channelId);
+        return;
+    }
+
+    while(!channelReceiveMessageQueue_.empty(channelId) && !channelReceiveRing->second->full())
+    {
+        channelReceiveRing->second->push(channelReceiveMessageQueue_.pop(channelId));
+    }
+
+    if(channelReceiveMessageQueue_.empty(channelId))
+    {
+        fullReceiveRings_.erase(channelId);
+    }
+    else if(fullReceiveRings_.insert(channelId).second)
+    {
+        // called from the consumer thread once it makes room
+        channelReceiveRing->second->notifyOnSpace([this, self = this->shared_from_this(), channelId]() {
+            receiveStrand_.post([this, self, channelId]() {
+                fullReceiveRings_.erase(channelId);
+                this->fillReceiveRing(channelId);
+                this->startReceive();
+            });
+        });
+    }
 }
 
 void Messenger::rejectSendPromiseQueue(const error::Error& e)
 {
-    while(!channelSendPromiseQueue_.empty())
+    for(auto& sendPromise : sendPromises_)
     {
-        auto queueElement(std::move(channelSendPromiseQueue_.front()));
-        channelSendPromiseQueue_.pop_front();
-        queueElement.second->reject(e);
+        sendPromise.second->reject(e);
+        channelSendPromiseQueue_.release(sendPromise.first);
     }
+
+    sendPromises_.clear();
+
+    channelSendPromiseQueue_.reject(e);
+}
+
+void Messenger::setSendClass(size_t classId, size_t priority, size_t weight)
+{
+    sendStrand_.dispatch([this, self = this->shared_from_this(), classId, priority, weight]() {
+        channelSendPromiseQueue_.setClass(classId, priority, weight);
+    });
+}
+
+void Messenger::setChannelSendClass(ChannelId channelId, size_t classId)
+{
+    sendStrand_.dispatch([this, self = this->shared_from_this(), channelId, classId]() {
+        channelSendPromiseQueue_.setChannelClass(channelId, classId);
+    });
+}
+
+std::vector<ChannelSendQueue::Statistics> Messenger::getSendStatistics() const
+{
+    return channelSendPromiseQueue_.getStatistics();
+}
+
+void Messenger::setSendWindow(size_t size)
+{
+    sendStrand_.dispatch([this, self = this->shared_from_this(), size]() {
+        sendWindow_ = std::max<size_t>(size, 1);
+        this->doSend();
+    });
+}
+
+void Messenger::setReceiveQueuePolicy(ChannelId channelId, ReceiveQueuePolicy policy, size_t limit)
+{
+    receiveStrand_.dispatch([this, self = this->shared_from_this(), channelId, policy, limit]() {
+        channelReceiveMessageQueue_.setPolicy(channelId, policy, limit);
+        this->startReceive();
+    });
+}
+
+ChannelReceiveMessageQueue::Statistics Messenger::getReceiveStatistics(ChannelId channelId) const
+{
+    return channelReceiveMessageQueue_.getStatistics(channelId);
+}
+
+ChannelReceiveRing::Pointer Messenger::openReceiveRing(ChannelId channelId, size_t capacity)
+{
+    auto channelReceiveRing = std::make_shared<ChannelReceiveRing>(capacity);
+
+    receiveStrand_.dispatch([this, self = this->shared_from_this(), channelId, channelReceiveRing]() {
+        auto previousChannelReceiveRing = channelReceiveRings_.find(channelId);
+
+        if(previousChannelReceiveRing != channelReceiveRings_.end())
+        {
+            previousChannelReceiveRing->second->close();
+            fullReceiveRings_.erase(channelId);
+        }
+
+        channelReceiveRings_[channelId] = channelReceiveRing;
+        this->fillReceiveRing(channelId);
+        this->startReceive();
+    });
+
+    return channelReceiveRing;
+}
+
+void Messenger::closeReceiveRing(ChannelId channelId)
+{
+    receiveStrand_.dispatch([this, self = this->shared_from_this(), channelId]() {
+        auto channelReceiveRing = channelReceiveRings_.find(channelId);
+
+        if(channelReceiveRing != channelReceiveRings_.end())
+        {
+            channelReceiveRing->second->close();
+            channelReceiveRings_.erase(channelReceiveRing);
+            fullReceiveRings_.erase(channelId);
+            this->startReceive();
+        }
+    });
 }
 
 void Messenger::stop()
 {
     receiveStrand_.dispatch([this, self = this->shared_from_this()]() {
         channelReceiveMessageQueue_.clear();
+        this->closeReceiveRings(error::Error(error::ErrorCode::OPERATION_ABORTED));
     });
 }
 
@@ -21,6 +21,10 @@
 #include <f1x/aasdk/Messenger/UT/MessageOutStream.mock.hpp>
 #include <f1x/aasdk/Messenger/UT/ReceivePromiseHandler.mock.hpp>
 #include <f1x/aasdk/Messenger/UT/SendPromiseHandler.mock.hpp>
+#include <f1x/aasdk/Messenger/UT/Cryptor.mock.hpp>
+#include <f1x/aasdk/Transport/UT/Transport.mock.hpp>
+#include <f1x/aasdk/Messenger/FrameHeader.hpp>
+#include <f1x/aasdk/Messenger/MessageOutStream.hpp>
 #include <f1x/aasdk/Messenger/Messenger.hpp>
 
 namespace f1x
@@ -35,6 +39,7 @@ namespace ut
 using ::testing::_;
 using ::testing::SaveArg;
 using ::testing::Return;
+using ::testing::Invoke;
 
 class MessengerUnitTest
 {
@@ -63,6 +68,14 @@ protected:
     SendPromise::Pointer sendPromise_;
 };
 
+SendPromise::Pointer createSendPromise(boost::asio::io_service& ioService, SendPromiseHandlerMock& sendPromiseHandlerMock)
+{
+    auto sendPromise = SendPromise::defer(ioService);
+    sendPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock),
+                      std::bind(&SendPromiseHandlerMock::onReject, &sendPromiseHandlerMock, std::placeholders::_1));
+    return sendPromise;
+}
+
 BOOST_FIXTURE_TEST_CASE(Messenger_Receive, MessengerUnitTest)
 {
     Messenger::Pointer themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
@@ -146,6 +159,100 @@ BOOST_FIXTURE_TEST_CASE(Messenger_OnlyOneReceiveAtATime, MessengerUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(Messenger_BlockedReceiveQueue, MessengerUnitTest)
+{
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
+    themessenger->setReceiveQueuePolicy(ChannelId::INPUT, ReceiveQueuePolicy::BLOCK, 1);
+    themessenger->enqueueReceive(ChannelId::MEDIA_AUDIO, std::move(receivePromise_));
+
+    ReceivePromise::Pointer inStreamReceivePromise;
+    EXPECT_CALL(messageInStreamMock_, startReceive(_)).WillOnce(SaveArg<0>(&inStreamReceivePromise));
+
+    ioService_.run();
+    ioService_.reset();
+
+    Message::Pointer inputChannelMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    inStreamReceivePromise->resolve(inputChannelMessage);
+
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_CHECK_EQUAL(themessenger->getReceiveStatistics(ChannelId::INPUT).queueDepth, 1u);
+    BOOST_CHECK_EQUAL(themessenger->getReceiveStatistics(ChannelId::INPUT).blockedCount, 1u);
+
+    auto secondReceivePromise = ReceivePromise::defer(ioService_);
+    secondReceivePromise->then(std::bind(&ReceivePromiseHandlerMock::onResolve, &receivePromiseHandlerMock_, std::placeholders::_1),
+                              std::bind(&ReceivePromiseHandlerMock::onReject, &receivePromiseHandlerMock_, std::placeholders::_1));
+
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(inputChannelMessage));
+    EXPECT_CALL(messageInStreamMock_, startReceive(_)).WillOnce(SaveArg<0>(&inStreamReceivePromise));
+    themessenger->enqueueReceive(ChannelId::INPUT, std::move(secondReceivePromise));
+
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(Messenger_ReceiveRing, MessengerUnitTest)
+{
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
+    auto receiveRing = themessenger->openReceiveRing(ChannelId::VIDEO, 8);
+
+    ReceivePromise::Pointer inStreamReceivePromise;
+    EXPECT_CALL(messageInStreamMock_, startReceive(_)).Times(2).WillRepeatedly(SaveArg<0>(&inStreamReceivePromise));
+
+    ioService_.run();
+    ioService_.reset();
+
+    Message::Pointer message(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    inStreamReceivePromise->resolve(message);
+
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_CHECK(receiveRing->tryPop() == message);
+    BOOST_CHECK(receiveRing->tryPop() == nullptr);
+
+    const error::Error e(error::ErrorCode::USB_TRANSFER, 41);
+    inStreamReceivePromise->reject(e);
+
+    ioService_.run();
+
+    BOOST_CHECK(receiveRing->isClosed());
+    BOOST_CHECK(receiveRing->getError() == e);
+}
+
+BOOST_FIXTURE_TEST_CASE(Messenger_FullReceiveRing, MessengerUnitTest)
+{
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
+    auto receiveRing = themessenger->openReceiveRing(ChannelId::VIDEO, 1);
+
+    ReceivePromise::Pointer inStreamReceivePromise;
+    EXPECT_CALL(messageInStreamMock_, startReceive(_)).Times(2).WillRepeatedly(SaveArg<0>(&inStreamReceivePromise));
+
+    ioService_.run();
+    ioService_.reset();
+
+    Message::Pointer message1(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer message2(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    inStreamReceivePromise->resolve(message1);
+    ioService_.run();
+    ioService_.reset();
+
+    // the ring is full, reading stops instead of dropping the message
+    inStreamReceivePromise->resolve(message2);
+    ioService_.run();
+    ioService_.reset();
+    ::testing::Mock::VerifyAndClearExpectations(&messageInStreamMock_);
+
+    EXPECT_CALL(messageInStreamMock_, startReceive(_)).WillOnce(SaveArg<0>(&inStreamReceivePromise));
+    BOOST_CHECK(receiveRing->tryPop() == message1);
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_CHECK(receiveRing->tryPop() == message2);
+    BOOST_CHECK_EQUAL(receiveRing->getDroppedMessagesCount(), 0u);
+}
+
 BOOST_FIXTURE_TEST_CASE(Messenger_Send, MessengerUnitTest)
 {
     Messenger::Pointer themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
@@ -197,6 +304,215 @@ BOOST_FIXTURE_TEST_CASE(Messenger_OnlyOneSendAtATime, MessengerUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(Messenger_SendByPriority, MessengerUnitTest)
+{
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
+    themessenger->setSendWindow(1);
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer audioMessage(std::make_shared<Message>(ChannelId::MEDIA_AUDIO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+
+    SendPromise::Pointer videoStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(videoMessage, _)).Times(2).WillRepeatedly(SaveArg<1>(&videoStreamSendPromise));
+    themessenger->enqueueSend(videoMessage, std::move(sendPromise_));
+
+    ioService_.run();
+    ioService_.reset();
+
+    // input takes the slot kept for the top priority class, audio and video wait for the window
+    SendPromise::Pointer inputStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(inputMessage, _)).WillOnce(SaveArg<1>(&inputStreamSendPromise));
+
+    for(const auto& message : {videoMessage, audioMessage, inputMessage})
+    {
+        themessenger->enqueueSend(message, createSendPromise(ioService_, sendPromiseHandlerMock_));
+    }
+
+    ioService_.run();
+    ioService_.reset();
+
+    const auto statistics = themessenger->getSendStatistics();
+    BOOST_CHECK_EQUAL(statistics.size(), 3u);
+    BOOST_CHECK_EQUAL(statistics[0].queueDepth, 0u);
+    BOOST_CHECK_EQUAL(statistics[0].sentMessagesCount, 1u);
+    BOOST_CHECK_EQUAL(statistics[1].queueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].queueDepth, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].sentMessagesCount, 1u);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(4);
+
+    inputStreamSendPromise->resolve();
+    ioService_.run();
+    ioService_.reset();
+
+    SendPromise::Pointer audioStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(audioMessage, _)).WillOnce(SaveArg<1>(&audioStreamSendPromise));
+    videoStreamSendPromise->resolve();
+    ioService_.run();
+    ioService_.reset();
+
+    audioStreamSendPromise->resolve();
+    ioService_.run();
+    ioService_.reset();
+
+    videoStreamSendPromise->resolve();
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(Messenger_OneSendPerChannelAtATime, MessengerUnitTest)
+{
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+
+    SendPromise::Pointer videoStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(videoMessage, _)).Times(2).WillRepeatedly(SaveArg<1>(&videoStreamSendPromise));
+    themessenger->enqueueSend(videoMessage, std::move(sendPromise_));
+
+    ioService_.run();
+    ioService_.reset();
+
+    auto secondSendPromise = SendPromise::defer(ioService_);
+    secondSendPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock_),
+                           std::bind(&SendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
+    themessenger->enqueueSend(videoMessage, std::move(secondSendPromise));
+
+    auto inputSendPromise = SendPromise::defer(ioService_);
+    inputSendPromise->then(std::bind(&SendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock_),
+                           std::bind(&SendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
+
+    SendPromise::Pointer inputStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(inputMessage, _)).WillOnce(SaveArg<1>(&inputStreamSendPromise));
+    themessenger->enqueueSend(inputMessage, std::move(inputSendPromise));
+
+    ioService_.run();
+    ioService_.reset();
+
+    const auto statistics = themessenger->getSendStatistics();
+    BOOST_CHECK_EQUAL(statistics[0].sentMessagesCount, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].sentMessagesCount, 1u);
+    BOOST_CHECK_EQUAL(statistics[2].queueDepth, 1u);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(3);
+    inputStreamSendPromise->resolve();
+    videoStreamSendPromise->resolve();
+    ioService_.run();
+    ioService_.reset();
+
+    videoStreamSendPromise->resolve();
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(Messenger_SendWindow, MessengerUnitTest)
+{
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer audioMessage(std::make_shared<Message>(ChannelId::MEDIA_AUDIO, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer microphoneMessage(std::make_shared<Message>(ChannelId::AV_INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::ENCRYPTED, MessageType::SPECIFIC));
+
+    SendPromise::Pointer videoStreamSendPromise;
+    SendPromise::Pointer audioStreamSendPromise;
+    SendPromise::Pointer inputStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(videoMessage, _)).WillOnce(SaveArg<1>(&videoStreamSendPromise));
+    EXPECT_CALL(messageOutStreamMock_, stream(audioMessage, _)).WillOnce(SaveArg<1>(&audioStreamSendPromise));
+    EXPECT_CALL(messageOutStreamMock_, stream(inputMessage, _)).WillOnce(SaveArg<1>(&inputStreamSendPromise));
+    EXPECT_CALL(messageOutStreamMock_, stream(microphoneMessage, _)).Times(0);
+
+    themessenger->enqueueSend(videoMessage, std::move(sendPromise_));
+    for(const auto& message : {audioMessage, microphoneMessage, inputMessage})
+    {
+        themessenger->enqueueSend(message, createSendPromise(ioService_, sendPromiseHandlerMock_));
+    }
+
+    ioService_.run();
+    ioService_.reset();
+
+    // the window is full, input goes out in the slot kept for the top priority class
+    const auto statistics = themessenger->getSendStatistics();
+    BOOST_CHECK_EQUAL(statistics[0].queueDepth, 0u);
+    BOOST_CHECK_EQUAL(statistics[2].queueDepth, 1u);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(4);
+
+    videoStreamSendPromise->resolve();
+    ioService_.run();
+    ioService_.reset();
+    ::testing::Mock::VerifyAndClearExpectations(&messageOutStreamMock_);
+
+    SendPromise::Pointer microphoneStreamSendPromise;
+    EXPECT_CALL(messageOutStreamMock_, stream(microphoneMessage, _)).WillOnce(SaveArg<1>(&microphoneStreamSendPromise));
+    inputStreamSendPromise->resolve();
+    ioService_.run();
+    ioService_.reset();
+
+    audioStreamSendPromise->resolve();
+    microphoneStreamSendPromise->resolve();
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(Messenger_InputOvertakesSplittedMessages, MessengerUnitTest)
+{
+    transport::ut::TransportMock transportMock;
+    transport::ITransport::Pointer transport(&transportMock, [](auto*) {});
+    CryptorMock cryptorMock;
+    ICryptor::Pointer cryptor(&cryptorMock, [](auto*) {});
+    auto themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, std::make_shared<MessageOutStream>(ioService_, transport, cryptor)));
+
+    const size_t maxFramePayloadSize = 0x4000;
+
+    Message::Pointer videoMessage(std::make_shared<Message>(ChannelId::VIDEO, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    videoMessage->insertPayload(common::Data(maxFramePayloadSize * 2, 0x5E));
+
+    Message::Pointer microphoneMessage(std::make_shared<Message>(ChannelId::AV_INPUT, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    microphoneMessage->insertPayload(common::Data(maxFramePayloadSize * 2, 0x5F));
+
+    Message::Pointer inputMessage(std::make_shared<Message>(ChannelId::INPUT, EncryptionType::PLAIN, MessageType::SPECIFIC));
+    inputMessage->insertPayload(common::Data(100, 0x60));
+
+    std::vector<std::pair<ChannelId, FrameType>> frames;
+    std::vector<transport::ITransport::SendPromise::Pointer> transportSendPromises;
+    EXPECT_CALL(transportMock, send(_, _)).Times(5).WillRepeatedly(Invoke([&](common::DataSequence data, transport::ITransport::SendPromise::Pointer promise) {
+        const FrameHeader frameHeader(data.head.empty() ? common::DataConstBuffer(data.payload) : common::DataConstBuffer(data.head));
+        frames.emplace_back(frameHeader.getChannelId(), frameHeader.getType());
+        transportSendPromises.push_back(std::move(promise));
+    }));
+
+    // both bulk transfers hold the send window
+    themessenger->enqueueSend(videoMessage, std::move(sendPromise_));
+    themessenger->enqueueSend(microphoneMessage, createSendPromise(ioService_, sendPromiseHandlerMock_));
+
+    ioService_.run();
+    ioService_.reset();
+
+    themessenger->enqueueSend(inputMessage, createSendPromise(ioService_, sendPromiseHandlerMock_));
+
+    ioService_.run();
+    ioService_.reset();
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(3);
+
+    for(size_t i = 0; i < 5; ++i)
+    {
+        BOOST_REQUIRE(i < transportSendPromises.size());
+        transportSendPromises[i]->resolve();
+        ioService_.run();
+        ioService_.reset();
+    }
+
+    const auto inputFrame = std::find(frames.begin(), frames.end(), std::make_pair(ChannelId::INPUT, FrameType::BULK));
+    const auto lastFrame = std::find_if(frames.begin(), frames.end(), [](const auto& frame) { return frame.second == FrameType::LAST; });
+    BOOST_CHECK(inputFrame != frames.end());
+    BOOST_CHECK(inputFrame < lastFrame);
+}
+
 BOOST_FIXTURE_TEST_CASE(Messenger_SendFailed, MessengerUnitTest)
 {
     Messenger::Pointer themessenger(std::make_shared<Messenger>(ioService_, messageInStream_, messageOutStream_));
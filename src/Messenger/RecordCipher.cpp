@@ -0,0 +1,264 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <openssl/ssl.h>
+#include <f1x/aasdk/Error/Error.hpp>
+#include <f1x/aasdk/Messenger/ICryptor.hpp>
+#include <f1x/aasdk/Messenger/RecordCipher.hpp>
+
+#if (OPENSSL_VERSION_NUMBER < 0x10100000L)
+// only the GCM names exist, SSLWrapper::getRecordKeys() does not hand out keys for such builds anyway
+#define EVP_CTRL_AEAD_GET_TAG EVP_CTRL_GCM_GET_TAG
+#define EVP_CTRL_AEAD_SET_TAG EVP_CTRL_GCM_SET_TAG
+#endif
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+
+namespace
+{
+
+constexpr size_t cNonceSize = 12;
+constexpr size_t cSequenceNumberSize = 8;
+
+void writeBigEndian(uint8_t* data, uint64_t value, size_t size)
+{
+    for(size_t i = size; i > 0; --i)
+    {
+        data[i - 1] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+}
+
+RecordCipher::RecordCipher(const EVP_CIPHER* cipher, const common::Data& key, const common::Data& iv, size_t explicitNonceSize,
+                           bool encryption, uint64_t sequenceNumber, uint64_t explicitNonce)
+    : context_(EVP_CIPHER_CTX_new())
+    , iv_(iv)
+    , explicitNonceSize_(explicitNonceSize)
+    , encryption_(encryption)
+    , sequenceNumber_(sequenceNumber)
+    , explicitNonce_(explicitNonce)
+{
+    if(context_ == nullptr || iv_.size() + explicitNonceSize_ != cNonceSize || EVP_CIPHER_key_length(cipher) != static_cast<int>(key.size())
+       || EVP_CipherInit_ex(context_, cipher, nullptr, key.data(), nullptr, encryption_ ? 1 : 0) != 1)
+    {
+        EVP_CIPHER_CTX_free(context_);
+        throw error::Error(error::ErrorCode::SSL_HANDSHAKE, SSL_ERROR_SSL);
+    }
+}
+
+RecordCipher::~RecordCipher()
+{
+    EVP_CIPHER_CTX_free(context_);
+    OPENSSL_cleanse(iv_.data(), iv_.size());
+}
+
+size_t RecordCipher::encrypt(common::Data& output, const common::DataConstBuffer& buffer)
+{
+    size_t totalSize = 0;
+    size_t offset = 0;
+
+    while(offset < buffer.size)
+    {
+        const size_t maxPayloadSize = cMaxPayloadSize;
+        const common::DataConstBuffer payloadBuffer(buffer.cdata, std::min(buffer.size, offset + maxPayloadSize), offset);
+        totalSize += this->encryptRecord(output, payloadBuffer);
+        offset += payloadBuffer.size;
+    }
+
+    return totalSize;
+}
+
+size_t RecordCipher::decrypt(common::Data& output, const common::DataConstBuffer& buffer)
+{
+    // plaintext is never larger than the records it comes from
+    const size_t beginOffset = output.size();
+    output.resize(beginOffset + pendingRecord_.size() + buffer.size);
+
+    try
+    {
+        const auto size = this->decrypt(common::DataBuffer(output, beginOffset), buffer);
+        output.resize(beginOffset + size);
+        return size;
+    }
+    catch(const error::Error&)
+    {
+        output.resize(beginOffset);
+        throw;
+    }
+}
+
+size_t RecordCipher::decrypt(common::DataBuffer output, const common::DataConstBuffer& buffer)
+{
+    // records normally come whole, one per frame, the copy is only made for a split one
+    const bool buffered = !pendingRecord_.empty();
+    if(buffered)
+    {
+        common::copy(pendingRecord_, buffer);
+    }
+
+    const common::DataConstBuffer input(buffered ? common::DataConstBuffer(pendingRecord_) : buffer);
+    size_t totalSize = 0;
+    size_t offset = 0;
+
+    while(input.size - offset >= cHeaderSize)
+    {
+        const size_t recordSize = cHeaderSize + ((input.cdata[offset + 3] << 8) | input.cdata[offset + 4]);
+
+        if(input.size - offset < recordSize)
+        {
+            break;
+        }
+
+        totalSize += this->decryptRecord(common::DataBuffer(output.data, output.size, totalSize), common::DataConstBuffer(input.cdata + offset, recordSize));
+        offset += recordSize;
+    }
+
+    if(buffered)
+    {
+        pendingRecord_.erase(pendingRecord_.begin(), pendingRecord_.begin() + offset);
+    }
+    else
+    {
+        pendingRecord_.assign(input.cdata + offset, input.cdata + input.size);
+    }
+
+    return totalSize;
+}
+
+size_t RecordCipher::encryptRecord(common::Data& output, const common::DataConstBuffer& buffer)
+{
+    const size_t length = explicitNonceSize_ + buffer.size + cTagSize;
+    const size_t beginOffset = output.size();
+    output.resize(beginOffset + cHeaderSize + length);
+
+    auto record = output.data() + beginOffset;
+    record[0] = SSL3_RT_APPLICATION_DATA;
+    record[1] = TLS1_2_VERSION_MAJOR;
+    record[2] = TLS1_2_VERSION_MINOR;
+    writeBigEndian(&record[3], length, 2);
+
+    const auto explicitNonce = record + cHeaderSize;
+    writeBigEndian(explicitNonce, explicitNonce_, explicitNonceSize_);
+    const auto ciphertext = explicitNonce + explicitNonceSize_;
+    int size = 0;
+
+    if(!this->setNonce(explicitNonce)
+       || !this->setAdditionalData(SSL3_RT_APPLICATION_DATA, buffer.size)
+       || EVP_CipherUpdate(context_, ciphertext, &size, buffer.cdata, buffer.size) != 1
+       || EVP_CipherFinal_ex(context_, ciphertext + size, &size) != 1
+       || EVP_CIPHER_CTX_ctrl(context_, EVP_CTRL_AEAD_GET_TAG, cTagSize, ciphertext + buffer.size) != 1)
+    {
+        output.resize(beginOffset);
+        throw error::Error(error::ErrorCode::SSL_WRITE, SSL_ERROR_SSL);
+    }
+
+    ++sequenceNumber_;
+    ++explicitNonce_;
+
+    return cHeaderSize + length;
+}
+
+size_t RecordCipher::decryptRecord(common::DataBuffer output, const common::DataConstBuffer& record)
+{
+    const size_t length = record.size - cHeaderSize;
+
+    if(length < explicitNonceSize_ + cTagSize || length > cMaxPayloadSize + ICryptor::cMaxRecordExpansionSize)
+    {
+        throw error::Error(error::ErrorCode::SSL_READ, SSL_ERROR_SSL);
+    }
+
+    const size_t payloadSize = length - explicitNonceSize_ - cTagSize;
+
+    if(payloadSize > output.size)
+    {
+        throw error::Error(error::ErrorCode::SSL_READ, SSL_ERROR_SSL);
+    }
+
+    const auto explicitNonce = record.cdata + cHeaderSize;
+    const auto ciphertext = explicitNonce + explicitNonceSize_;
+    auto tag = const_cast<uint8_t*>(ciphertext + payloadSize);
+    int size = 0;
+
+    if(!this->setNonce(explicitNonce)
+       || !this->setAdditionalData(record.cdata[0], payloadSize)
+       || EVP_CipherUpdate(context_, output.data, &size, ciphertext, payloadSize) != 1
+       || EVP_CIPHER_CTX_ctrl(context_, EVP_CTRL_AEAD_SET_TAG, cTagSize, tag) != 1
+       || EVP_CipherFinal_ex(context_, output.data + size, &size) != 1)
+    {
+        throw error::Error(error::ErrorCode::SSL_READ, SSL_ERROR_SSL);
+    }
+
+    ++sequenceNumber_;
+
+    if(record.cdata[0] != SSL3_RT_APPLICATION_DATA)
+    {
+        // an alert ends the session the same way SSL_read reports it
+        throw error::Error(error::ErrorCode::SSL_READ, record.cdata[0] == SSL3_RT_ALERT ? SSL_ERROR_ZERO_RETURN : SSL_ERROR_SSL);
+    }
+
+    return payloadSize;
+}
+
+bool RecordCipher::setNonce(const uint8_t* explicitNonce)
+{
+    // RFC 5288 for GCM: fixed iv followed by the explicit nonce, RFC 7905 for ChaCha20: iv xored with the sequence number
+    uint8_t nonce[cNonceSize];
+    std::copy(iv_.begin(), iv_.end(), nonce);
+
+    if(explicitNonceSize_ > 0)
+    {
+        std::copy(explicitNonce, explicitNonce + explicitNonceSize_, nonce + iv_.size());
+    }
+    else
+    {
+        uint8_t sequenceNumber[cSequenceNumberSize];
+        writeBigEndian(sequenceNumber, sequenceNumber_, cSequenceNumberSize);
+
+        for(size_t i = 0; i < cSequenceNumberSize; ++i)
+        {
+            nonce[cNonceSize - cSequenceNumberSize + i] ^= sequenceNumber[i];
+        }
+    }
+
+    return EVP_CipherInit_ex(context_, nullptr, nullptr, nullptr, nonce, encryption_ ? 1 : 0) == 1;
+}
+
+bool RecordCipher::setAdditionalData(uint8_t type, size_t size)
+{
+    uint8_t additionalData[cSequenceNumberSize + cHeaderSize];
+    writeBigEndian(additionalData, sequenceNumber_, cSequenceNumberSize);
+    additionalData[cSequenceNumberSize] = type;
+    additionalData[cSequenceNumberSize + 1] = TLS1_2_VERSION_MAJOR;
+    additionalData[cSequenceNumberSize + 2] = TLS1_2_VERSION_MINOR;
+    writeBigEndian(&additionalData[cSequenceNumberSize + 3], size, 2);
+
+    int outputSize = 0;
+    return EVP_CipherUpdate(context_, nullptr, &outputSize, additionalData, sizeof(additionalData)) == 1;
+}
+
+}
+}
+}
@@ -0,0 +1,152 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+#include <f1x/aasdk/Messenger/RecordCipher.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace messenger
+{
+namespace ut
+{
+
+class RecordCipherUnitTest
+{
+protected:
+    RecordCipherUnitTest()
+        : key_(16, 0x11)
+        , iv_(4, 0x22)
+        , encryptor_(EVP_aes_128_gcm(), key_, iv_, 8, true, 1, 0x0102030405060708)
+        , decryptor_(EVP_aes_128_gcm(), key_, iv_, 8, false, 1)
+    {
+    }
+
+    common::Data key_;
+    common::Data iv_;
+    RecordCipher encryptor_;
+    RecordCipher decryptor_;
+};
+
+BOOST_FIXTURE_TEST_CASE(RecordCipher_EncryptDecrypt, RecordCipherUnitTest)
+{
+    const common::Data payload(1000, 0x5E);
+    common::Data record;
+    BOOST_CHECK_EQUAL(encryptor_.encrypt(record, common::DataConstBuffer(payload)), 5 + 8 + 1000 + 16);
+
+    const common::Data expectedHeader{0x17, 0x03, 0x03, 0x04, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    BOOST_CHECK(std::equal(expectedHeader.begin(), expectedHeader.end(), record.begin()));
+
+    common::Data output;
+    BOOST_CHECK_EQUAL(decryptor_.decrypt(output, common::DataConstBuffer(record)), payload.size());
+    BOOST_CHECK(output == payload);
+
+    // next record carries the next explicit nonce and sequence number
+    record.clear();
+    encryptor_.encrypt(record, common::DataConstBuffer(payload));
+    BOOST_CHECK_EQUAL(record[12], 0x09);
+
+    output.clear();
+    decryptor_.decrypt(output, common::DataConstBuffer(record));
+    BOOST_CHECK(output == payload);
+}
+
+BOOST_FIXTURE_TEST_CASE(RecordCipher_SplitLargePayload, RecordCipherUnitTest)
+{
+    common::Data payload(RecordCipher::cMaxPayloadSize + 1000);
+    for(size_t i = 0; i < payload.size(); ++i)
+    {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+
+    common::Data records;
+    BOOST_CHECK_EQUAL(encryptor_.encrypt(records, common::DataConstBuffer(payload)), payload.size() + 2 * (5 + 8 + 16));
+
+    common::Data output;
+    BOOST_CHECK_EQUAL(decryptor_.decrypt(output, common::DataConstBuffer(records)), payload.size());
+    BOOST_CHECK(output == payload);
+}
+
+BOOST_FIXTURE_TEST_CASE(RecordCipher_PartialRecord, RecordCipherUnitTest)
+{
+    const common::Data payload(1000, 0x5E);
+    common::Data record;
+    encryptor_.encrypt(record, common::DataConstBuffer(payload));
+
+    common::Data output;
+    BOOST_CHECK_EQUAL(decryptor_.decrypt(output, common::DataConstBuffer(&record[0], 3)), 0);
+    BOOST_CHECK_EQUAL(decryptor_.decrypt(output, common::DataConstBuffer(&record[3], 500)), 0);
+    BOOST_CHECK(output.empty());
+
+    BOOST_CHECK_EQUAL(decryptor_.decrypt(output, common::DataConstBuffer(record, 503)), payload.size());
+    BOOST_CHECK(output == payload);
+}
+
+BOOST_FIXTURE_TEST_CASE(RecordCipher_TamperedRecord, RecordCipherUnitTest)
+{
+    const common::Data payload(1000, 0x5E);
+    common::Data record;
+    encryptor_.encrypt(record, common::DataConstBuffer(payload));
+    record[100] ^= 0x01;
+
+    common::Data output;
+    BOOST_CHECK_THROW(decryptor_.decrypt(output, common::DataConstBuffer(record)), error::Error);
+    BOOST_CHECK(output.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(RecordCipher_SequenceNumberMismatch, RecordCipherUnitTest)
+{
+    RecordCipher decryptor(EVP_aes_128_gcm(), key_, iv_, 8, false, 2);
+    const common::Data payload(1000, 0x5E);
+    common::Data record;
+    encryptor_.encrypt(record, common::DataConstBuffer(payload));
+
+    common::Data output;
+    BOOST_CHECK_THROW(decryptor.decrypt(output, common::DataConstBuffer(record)), error::Error);
+}
+
+BOOST_AUTO_TEST_CASE(RecordCipher_ChaCha20Poly1305)
+{
+    const common::Data key(32, 0x11);
+    const common::Data iv(12, 0x22);
+    RecordCipher encryptor(EVP_chacha20_poly1305(), key, iv, 0, true, 1);
+    RecordCipher decryptor(EVP_chacha20_poly1305(), key, iv, 0, false, 1);
+
+    const common::Data payload(1000, 0x5E);
+    common::Data records;
+    BOOST_CHECK_EQUAL(encryptor.encrypt(records, common::DataConstBuffer(payload)), 5 + 1000 + 16);
+    encryptor.encrypt(records, common::DataConstBuffer(payload));
+
+    common::Data output;
+    BOOST_CHECK_EQUAL(decryptor.decrypt(output, common::DataConstBuffer(records)), 2 * payload.size());
+    BOOST_CHECK(std::equal(payload.begin(), payload.end(), output.begin()));
+    BOOST_CHECK(std::equal(payload.begin(), payload.end(), output.begin() + payload.size()));
+}
+
+BOOST_AUTO_TEST_CASE(RecordCipher_InvalidKey)
+{
+    BOOST_CHECK_THROW(RecordCipher(EVP_aes_128_gcm(), common::Data(8, 0x11), common::Data(4, 0x22), 8, true), error::Error);
+}
+
+}
+}
+}
+}
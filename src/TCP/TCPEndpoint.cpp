@@ -32,9 +32,9 @@ TCPEndpoint::TCPEndpoint(ITCPWrapper& tcpWrapper, SocketPointer socket)
 
 }
 
-void TCPEndpoint::send(common::DataConstBuffer buffer, Promise::Pointer promise)
+void TCPEndpoint::send(common::DataConstBufferSequence buffers, Promise::Pointer promise)
 {
-    tcpWrapper_.asyncWrite(*socket_, std::move(buffer),
+    tcpWrapper_.asyncWrite(*socket_, std::move(buffers),
                            std::bind(&TCPEndpoint::asyncOperationHandler,
                                      this->shared_from_this(),
                                      std::placeholders::_1,
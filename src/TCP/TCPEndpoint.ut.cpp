@@ -97,10 +97,10 @@ BOOST_FIXTURE_TEST_CASE(TCPEndpoint_Send, TCPEndpointUnitTest)
     auto tcpEndpoint = std::make_shared<TCPEndpoint>(tcpWrapperMock_, std::move(socket_));
 
     common::Data actualData(100, 0);
-    common::DataConstBuffer buffer(actualData);
+    const common::DataConstBufferSequence buffers{{common::DataConstBuffer(actualData), common::DataConstBuffer()}};
     ITCPWrapper::Handler handler;
-    EXPECT_CALL(tcpWrapperMock_, asyncWrite(_, buffer, _)).WillOnce(SaveArg<2>(&handler));
-    tcpEndpoint->send(common::DataConstBuffer(actualData), std::move(promise_));
+    EXPECT_CALL(tcpWrapperMock_, asyncWrite(_, buffers, _)).WillOnce(SaveArg<2>(&handler));
+    tcpEndpoint->send(buffers, std::move(promise_));
 
     EXPECT_CALL(promiseHandlerMock_, onResolve(actualData.size()));
     EXPECT_CALL(promiseHandlerMock_, onReject(_)).Times(0);
@@ -114,10 +114,10 @@ BOOST_FIXTURE_TEST_CASE(TCPEndpoint_SendError, TCPEndpointUnitTest)
     auto tcpEndpoint = std::make_shared<TCPEndpoint>(tcpWrapperMock_, std::move(socket_));
 
     common::Data actualData(100, 0);
-    common::DataConstBuffer buffer(actualData);
+    const common::DataConstBufferSequence buffers{{common::DataConstBuffer(actualData), common::DataConstBuffer()}};
     ITCPWrapper::Handler handler;
-    EXPECT_CALL(tcpWrapperMock_, asyncWrite(_, buffer, _)).WillOnce(SaveArg<2>(&handler));
-    tcpEndpoint->send(common::DataConstBuffer(actualData), std::move(promise_));
+    EXPECT_CALL(tcpWrapperMock_, asyncWrite(_, buffers, _)).WillOnce(SaveArg<2>(&handler));
+    tcpEndpoint->send(buffers, std::move(promise_));
 
     EXPECT_CALL(promiseHandlerMock_, onResolve(_)).Times(0);
     EXPECT_CALL(promiseHandlerMock_, onReject(error::Error(error::ErrorCode::OPERATION_ABORTED)));
@@ -26,9 +26,14 @@ namespace aasdk
 namespace tcp
 {
 
-void TCPWrapper::asyncWrite(boost::asio::ip::tcp::socket& socket, common::DataConstBuffer buffer, Handler handler)
+void TCPWrapper::asyncWrite(boost::asio::ip::tcp::socket& socket, common::DataConstBufferSequence buffers, Handler handler)
 {
-    boost::asio::async_write(socket, boost::asio::buffer(buffer.cdata, buffer.size), std::move(handler));
+    const std::array<boost::asio::const_buffer, std::tuple_size<common::DataConstBufferSequence>::value> bufferSequence{{
+        boost::asio::buffer(buffers[0].cdata, buffers[0].size),
+        boost::asio::buffer(buffers[1].cdata, buffers[1].size)
+    }};
+
+    boost::asio::async_write(socket, bufferSequence, std::move(handler));
 }
 
 void TCPWrapper::asyncRead(boost::asio::ip::tcp::socket& socket, common::DataBuffer buffer, Handler handler)
@@ -0,0 +1,154 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <boost/test/unit_test.hpp>
+#include <boost/circular_buffer.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+#include <f1x/aasdk/Transport/DataSink.hpp>
+#include <f1x/aasdk/Transport/HeapDataSinkStorage.hpp>
+#include <f1x/aasdk/Transport/MirroredDataSinkStorage.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace transport
+{
+namespace bench
+{
+
+// Sink as it was before slices: boost::circular_buffer that is linearized whenever it wraps.
+class CircularBufferDataSink
+{
+public:
+    CircularBufferDataSink(common::Data::size_type capacity)
+        : data_(capacity)
+    {
+    }
+
+    common::DataBuffer fill()
+    {
+        const auto offset = data_.size();
+        data_.resize(data_.size() + cChunkSize);
+
+        auto ptr = data_.is_linearized() ? &data_[offset] : data_.linearize() + offset;
+        return common::DataBuffer(ptr, cChunkSize);
+    }
+
+    void commit(common::Data::size_type size)
+    {
+        data_.erase_end((cChunkSize - size));
+    }
+
+    common::Data::size_type getAvailableSize()
+    {
+        return data_.size();
+    }
+
+    common::Data consume(common::Data::size_type size)
+    {
+        common::Data data(size, 0);
+        std::copy(data_.begin(), data_.begin() + size, data.begin());
+        data_.erase_begin(size);
+
+        return data;
+    }
+
+private:
+    boost::circular_buffer<common::Data::value_type> data_;
+    static constexpr common::Data::size_type cChunkSize = 16384;
+};
+
+inline const common::Data::value_type* getLastByte(const common::Data& data)
+{
+    return &data.back();
+}
+
+inline const common::Data::value_type* getLastByte(const common::DataSlice& slice)
+{
+    return slice.cdata + slice.size - 1;
+}
+
+// Keeps a backlog of received bytes in the sink, so the read and write positions keep crossing the end of the ring.
+template<typename SinkType>
+double measureWrapHeavyThroughput(SinkType& sink)
+{
+    static constexpr size_t cBacklogSize = 96 * 1024;
+    static constexpr size_t cTotalSize = 1024 * 1024 * 1024;
+
+    std::mt19937 generator(1234);
+    std::uniform_int_distribution<size_t> receiveSizeDistribution(512, 16384);
+    std::uniform_int_distribution<size_t> payloadSizeDistribution(16, 16384);
+
+    size_t consumedSize = 0;
+    uint64_t checksum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+
+    while(consumedSize < cTotalSize)
+    {
+        while(sink.getAvailableSize() < cBacklogSize)
+        {
+            auto buffer = sink.fill();
+            const auto receiveSize = receiveSizeDistribution(generator);
+            std::fill(buffer.data, buffer.data + receiveSize, static_cast<common::Data::value_type>(consumedSize | 1));
+            sink.commit(receiveSize);
+        }
+
+        // frame header, frame size and payload
+        for(auto size : {size_t(2), size_t(2), payloadSizeDistribution(generator)})
+        {
+            auto data = sink.consume(size);
+            checksum += *getLastByte(data);
+            consumedSize += size;
+        }
+    }
+
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - begin;
+    BOOST_TEST(checksum != 0);
+
+    return cTotalSize / duration.count() / (1024 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(DataSink_WrapHeavyThroughput)
+{
+    static constexpr size_t cCapacity = 256 * 1024;
+
+    CircularBufferDataSink circularBufferSink(cCapacity);
+    std::cout << "circular buffer sink:         " << measureWrapHeavyThroughput(circularBufferSink) << " MB/s" << std::endl;
+
+    DataSink heapSink(std::make_shared<HeapDataSinkStorage>(cCapacity, 64 * 1024));
+    std::cout << "heap storage data sink:       " << measureWrapHeavyThroughput(heapSink) << " MB/s" << std::endl;
+
+    try
+    {
+        DataSink mirroredSink(std::make_shared<MirroredDataSinkStorage>(cCapacity));
+        std::cout << "mirrored storage data sink:   " << measureWrapHeavyThroughput(mirroredSink) << " MB/s" << std::endl;
+    }
+    catch(const error::Error& e)
+    {
+        std::cout << "mirrored storage data sink:   not available (" << e.what() << ")" << std::endl;
+    }
+}
+
+}
+}
+}
+}
@@ -16,8 +16,12 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
 #include <f1x/aasdk/Transport/DataSink.hpp>
+#include <f1x/aasdk/Transport/MirroredDataSinkStorage.hpp>
+#include <f1x/aasdk/Transport/HeapDataSinkStorage.hpp>
+#include <f1x/aasdk/Common/Log.hpp>
 #include <f1x/aasdk/Error/Error.hpp>
 
 namespace f1x
@@ -27,47 +31,398 @@ namespace aasdk
 namespace transport
 {
 
-DataSink::DataSink()
-    : data_(common::cStaticDataSize)
+DataSink::DataSink(common::Data::size_type capacityLimit)
+    : DataSink(createStorage(std::min(capacityLimit, cInitialCapacity)), capacityLimit)
 {
 }
 
+DataSink::DataSink(IDataSinkStorage::Pointer storage)
+    : DataSink(storage, storage->getCapacity())
+{
+}
+
+DataSink::DataSink(IDataSinkStorage::Pointer storage, common::Data::size_type capacityLimit)
+    : releaseNotifier_(std::make_shared<ReleaseNotifier>())
+    , tailPosition_(0)
+    , readPosition_(0)
+    , writePosition_(0)
+    , availableSize_(0)
+    , initialCapacity_(storage->getCapacity())
+    , capacityLimit_(capacityLimit)
+    , highWaterMark_(0)
+    , recentUsedSize_(0)
+    , idleCount_(0)
+{
+    this->setStorage(std::move(storage));
+}
+
 common::DataBuffer DataSink::fill()
 {
-    const auto offset = data_.size();
-    data_.resize(data_.size() + cChunkSize);
+    this->reclaim();
+
+    // ring cannot be replaced while transfers are still writing into it
+    if(this->getFreeSize() < cChunkSize && windows_.empty() && capacity_ < capacityLimit_)
+    {
+        this->resize(std::min(capacityLimit_, std::max<common::Data::size_type>(capacity_ * 2, writePosition_ - readPosition_ + cChunkSize)));
+    }
+
+    if(this->getFreeSize() < cChunkSize)
+    {
+        // unread data alone does not leave room for another chunk, waiting for slices to be released will not help
+        if(windows_.empty() && writePosition_ - readPosition_ + cChunkSize > capacity_)
+        {
+            throw error::Error(error::ErrorCode::DATA_SINK_COMMIT_OVERFLOW);
+        }
+
+        return common::DataBuffer();
+    }
 
-    auto ptr = data_.is_linearized() ? &data_[offset] : data_.linearize() + offset;
-    return common::DataBuffer(ptr, cChunkSize);
+    common::DataBuffer buffer(this->getPointer(writePosition_), cChunkSize);
+    windows_.push_back(writePosition_);
+    writePosition_ += cChunkSize;
+
+    return buffer;
 }
 
 void DataSink::commit(common::Data::size_type size)
 {
-    if(size > cChunkSize)
+    if(windows_.empty() || size > cChunkSize)
     {
         throw error::Error(error::ErrorCode::DATA_SINK_COMMIT_OVERFLOW);
     }
 
-    data_.erase_end((cChunkSize - size));
+    const auto position = windows_.front();
+    windows_.pop_front();
+    this->updateMirror(position, size);
+
+    if(size > 0)
+    {
+        if(!segments_.empty() && segments_.back().second == position)
+        {
+            segments_.back().second += size;
+        }
+        else
+        {
+            segments_.emplace_back(position, position + size);
+        }
+
+        availableSize_ += size;
+    }
+
+    // last outstanding window gives back the part that was not filled
+    if(windows_.empty())
+    {
+        writePosition_ = position + size;
+    }
+
+    this->updateReadPosition();
+
+    const common::Data::size_type usedSize = writePosition_ - tailPosition_;
+    recentUsedSize_ = std::max(recentUsedSize_, usedSize);
+
+    if(usedSize > highWaterMark_.load(std::memory_order_relaxed))
+    {
+        highWaterMark_.store(usedSize, std::memory_order_relaxed);
+    }
 }
 
 common::Data::size_type DataSink::getAvailableSize()
 {
-    return data_.size();
+    return availableSize_;
 }
 
-common::Data DataSink::consume(common::Data::size_type size)
+common::Data::size_type DataSink::getContiguousSize() const
 {
-    if(size > data_.size())
+    if(segments_.empty())
+    {
+        return 0;
+    }
+
+    const auto& segment = segments_.front();
+    const common::Data::size_type offset = segment.first % capacity_;
+    return std::min<common::Data::size_type>(segment.second - segment.first, capacity_ + mirrorSize_ - offset);
+}
+
+common::DataSlice DataSink::consume(common::Data::size_type size)
+{
+    if(size > availableSize_)
     {
         throw error::Error(error::ErrorCode::DATA_SINK_CONSUME_UNDERFLOW);
     }
 
-    common::Data data(size, 0);
-    std::copy(data_.begin(), data_.begin() + size, data.begin());
-    data_.erase_begin(size);
+    if(size == 0)
+    {
+        return common::DataSlice();
+    }
+
+    auto& segment = segments_.front();
+    const common::Data::size_type offset = segment.first % capacity_;
+    common::DataSlice slice;
+
+    if(segment.second - segment.first >= size && offset + size <= capacity_ + mirrorSize_)
+    {
+        slice = common::DataSlice(this->getPage(offset / pageSize_), common::DataConstBuffer(this->getPointer(segment.first), size));
+        segment.first += size;
+
+        if(segment.first == segment.second)
+        {
+            segments_.pop_front();
+        }
+    }
+    else
+    {
+        // range wraps further than the mirror reaches or spans several transfers, gather it into one owned buffer
+        common::Data buffer;
+        buffer.reserve(size);
+
+        while(buffer.size() < size)
+        {
+            auto& front = segments_.front();
+            const auto partSize = std::min<common::Data::size_type>(size - buffer.size(), front.second - front.first);
+            const common::Data::size_type partOffset = front.first % capacity_;
+            const auto firstPartSize = std::min(partSize, capacity_ - partOffset);
+            const auto data = storage_->getData();
+
+            buffer.insert(buffer.end(), data + partOffset, data + partOffset + firstPartSize);
+            buffer.insert(buffer.end(), data, data + (partSize - firstPartSize));
+            front.first += partSize;
+
+            if(front.first == front.second)
+            {
+                segments_.pop_front();
+            }
+        }
+
+        slice = common::DataSlice(std::move(buffer));
+    }
+
+    availableSize_ -= size;
+    this->updateReadPosition();
+
+    if(availableSize_ == 0 && windows_.empty())
+    {
+        this->reclaim();
+
+        // nothing is buffered or referenced, start over from the beginning of the ring while it is warm
+        if(tailPosition_ == readPosition_)
+        {
+            tailPosition_ = readPosition_ = writePosition_ = 0;
+            this->shrinkIfIdle();
+        }
+    }
+
+    return slice;
+}
+
+void DataSink::notifyOnRelease(std::function<void()> handler)
+{
+    {
+        std::lock_guard<std::mutex> lock(releaseNotifier_->mutex);
+        releaseNotifier_->handler = std::move(handler);
+    }
+
+    // slices released before the handler was set did not notify anybody
+    this->reclaim();
 
-    return data;
+    if(this->getFreeSize() >= cChunkSize)
+    {
+        releaseNotifier_->notify();
+    }
+}
+
+void DataSink::cancelReleaseNotification()
+{
+    std::lock_guard<std::mutex> lock(releaseNotifier_->mutex);
+    releaseNotifier_->handler = nullptr;
+}
+
+void DataSink::ReleaseNotifier::notify()
+{
+    std::function<void()> releaseHandler;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(releaseHandler, handler);
+    }
+
+    if(releaseHandler)
+    {
+        releaseHandler();
+    }
+}
+
+common::Data::size_type DataSink::getCapacity() const
+{
+    return capacity_;
+}
+
+common::Data::size_type DataSink::getCapacityLimit() const
+{
+    return capacityLimit_;
+}
+
+common::Data::size_type DataSink::getHighWaterMark() const
+{
+    return highWaterMark_.load(std::memory_order_relaxed);
+}
+
+IDataSinkStorage::Pointer DataSink::createStorage(common::Data::size_type capacity)
+{
+    const auto granularity = MirroredDataSinkStorage::getGranularity();
+
+    try
+    {
+        return std::make_shared<MirroredDataSinkStorage>((capacity + granularity - 1) / granularity * granularity);
+    }
+    catch(const error::Error& e)
+    {
+        AASDK_LOG(warning) << "[DataSink] mirrored storage is not available, falling back to heap storage: " << e.what();
+        return std::make_shared<HeapDataSinkStorage>(capacity, std::min(capacity, cChunkSize * 4));
+    }
+}
+
+void DataSink::setStorage(IDataSinkStorage::Pointer storage)
+{
+    const auto capacity = storage->getCapacity();
+    const auto mirrorSize = std::min(storage->getMirrorSize(), capacity);
+
+    if(mirrorSize < cChunkSize || capacity < cChunkSize * 2)
+    {
+        throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING);
+    }
+
+    storage_ = std::move(storage);
+    capacity_ = capacity;
+    mirrorSize_ = mirrorSize;
+    pageSize_ = (capacity_ + cPagesCount - 1) / cPagesCount;
+
+    pages_.clear();
+    pages_.resize(cPagesCount);
+}
+
+DataSink::Page DataSink::getPage(size_t index)
+{
+    auto page = pages_[index].lock();
+
+    if(page == nullptr)
+    {
+        // every page shares the storage, so slices keep it alive even if the sink or the storage goes away
+        page = Page(new IDataSinkStorage::Pointer(storage_), [releaseNotifier = releaseNotifier_](IDataSinkStorage::Pointer* storage) {
+            delete storage;
+            releaseNotifier->notify();
+        });
+        pages_[index] = page;
+    }
+
+    return page;
+}
+
+void DataSink::resize(common::Data::size_type capacity)
+{
+    auto storage = createStorage(capacity);
+    const auto data = storage_->getData();
+    common::Data::size_type size = 0;
+
+    // unread bytes move to the beginning of the new ring, bytes held by slices stay in the old storage
+    for(const auto& segment : segments_)
+    {
+        const auto segmentSize = segment.second - segment.first;
+        const common::Data::size_type offset = segment.first % capacity_;
+        const auto firstPartSize = std::min<common::Data::size_type>(segmentSize, capacity_ - offset);
+
+        memcpy(storage->getData() + size, data + offset, firstPartSize);
+        memcpy(storage->getData() + size + firstPartSize, data, segmentSize - firstPartSize);
+        size += segmentSize;
+    }
+
+    this->setStorage(std::move(storage));
+    segments_.clear();
+
+    if(size > 0)
+    {
+        segments_.emplace_back(0, size);
+    }
+
+    tailPosition_ = readPosition_ = 0;
+    writePosition_ = size;
+    this->updateMirror(0, size);
+
+    recentUsedSize_ = size;
+    idleCount_ = 0;
+}
+
+void DataSink::shrinkIfIdle()
+{
+    if(capacity_ <= initialCapacity_ || recentUsedSize_ > capacity_ / 4)
+    {
+        idleCount_ = 0;
+    }
+    else if(++idleCount_ >= cShrinkIdleCount)
+    {
+        this->resize(std::max(initialCapacity_, capacity_ / 2));
+    }
+
+    recentUsedSize_ = 0;
+}
+
+void DataSink::updateReadPosition()
+{
+    if(!segments_.empty())
+    {
+        readPosition_ = segments_.front().first;
+    }
+    else
+    {
+        readPosition_ = windows_.empty() ? writePosition_ : windows_.front();
+    }
+}
+
+common::Data::size_type DataSink::getFreeSize() const
+{
+    return capacity_ - (writePosition_ - tailPosition_);
+}
+
+common::Data::value_type* DataSink::getPointer(uint64_t position)
+{
+    return storage_->getData() + position % capacity_;
+}
+
+void DataSink::updateMirror(uint64_t position, common::Data::size_type size)
+{
+    if(storage_->isMirrored() || size == 0)
+    {
+        return;
+    }
+
+    const auto data = storage_->getData();
+    const common::Data::size_type offset = position % capacity_;
+
+    if(offset + size > capacity_)
+    {
+        // end of the written window landed in the mirror, bring it to the beginning of the ring
+        memcpy(data, data + capacity_, offset + size - capacity_);
+    }
+
+    if(offset < mirrorSize_)
+    {
+        memcpy(data + capacity_ + offset, data + offset, std::min(offset + size, mirrorSize_) - offset);
+    }
+}
+
+void DataSink::reclaim()
+{
+    while(tailPosition_ < readPosition_)
+    {
+        const common::Data::size_type offset = tailPosition_ % capacity_;
+        // page is still referenced by a slice
+        if(!pages_[offset / pageSize_].expired())
+        {
+            break;
+        }
+
+        const auto pageEnd = std::min<common::Data::size_type>((offset / pageSize_ + 1) * pageSize_, capacity_);
+        tailPosition_ = std::min<uint64_t>(tailPosition_ + (pageEnd - offset), readPosition_);
+    }
 }
 
 }
@@ -0,0 +1,139 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <f1x/aasdk/Transport/MirroredDataSinkStorage.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace transport
+{
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+
+MirroredDataSinkStorage::MirroredDataSinkStorage(common::Data::size_type capacity)
+    : data_(nullptr)
+    , capacity_(capacity)
+{
+    if(capacity_ == 0 || capacity_ % getGranularity() != 0)
+    {
+        throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING, EINVAL);
+    }
+
+    const int fd = syscall(SYS_memfd_create, "aasdk_data_sink", 1U /* MFD_CLOEXEC */);
+
+    if(fd < 0)
+    {
+        throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING, errno);
+    }
+
+    if(ftruncate(fd, capacity_) != 0)
+    {
+        const auto result = errno;
+        close(fd);
+        throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING, result);
+    }
+
+    // reserve address space for both views first, so nothing else can land in between
+    auto address = mmap(nullptr, capacity_ * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(address == MAP_FAILED)
+    {
+        const auto result = errno;
+        close(fd);
+        throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING, result);
+    }
+
+    data_ = reinterpret_cast<common::Data::value_type*>(address);
+
+    for(auto view : {data_, data_ + capacity_})
+    {
+        if(mmap(view, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            const auto result = errno;
+            munmap(data_, capacity_ * 2);
+            close(fd);
+            throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING, result);
+        }
+    }
+
+    // mappings keep the memory object alive
+    close(fd);
+}
+
+MirroredDataSinkStorage::~MirroredDataSinkStorage()
+{
+    munmap(data_, capacity_ * 2);
+}
+
+common::Data::size_type MirroredDataSinkStorage::getGranularity()
+{
+    return sysconf(_SC_PAGESIZE);
+}
+
+#else
+
+MirroredDataSinkStorage::MirroredDataSinkStorage(common::Data::size_type capacity)
+    : data_(nullptr)
+    , capacity_(capacity)
+{
+    throw error::Error(error::ErrorCode::DATA_SINK_MEMORY_MAPPING);
+}
+
+MirroredDataSinkStorage::~MirroredDataSinkStorage()
+{
+}
+
+common::Data::size_type MirroredDataSinkStorage::getGranularity()
+{
+    return 4096;
+}
+
+#endif
+
+common::Data::value_type* MirroredDataSinkStorage::getData()
+{
+    return data_;
+}
+
+common::Data::size_type MirroredDataSinkStorage::getCapacity() const
+{
+    return capacity_;
+}
+
+common::Data::size_type MirroredDataSinkStorage::getMirrorSize() const
+{
+    return capacity_;
+}
+
+bool MirroredDataSinkStorage::isMirrored() const
+{
+    return true;
+}
+
+}
+}
+}
@@ -21,6 +21,9 @@
 #include <openssl/err.h>
 #include <openssl/ssl.h>
 #include <openssl/conf.h>
+#if (OPENSSL_VERSION_NUMBER >= 0x10100000L)
+#include <openssl/kdf.h>
+#endif
 #include <f1x/aasdk/Transport/SSLWrapper.hpp>
 
 namespace f1x
@@ -120,6 +123,10 @@ void SSLWrapper::setBIOs(SSL* ssl, const BIOs& bIOs, size_t maxBufferSize)
 void SSLWrapper::setConnectState(SSL* ssl)
 {
     SSL_set_connect_state(ssl);
+#ifdef SSL_OP_NO_RENEGOTIATION
+    // the record ciphers exported after the handshake would not follow a renegotiation
+    SSL_set_options(ssl, SSL_OP_NO_RENEGOTIATION);
+#endif
     SSL_set_verify(ssl, SSL_VERIFY_NONE, nullptr);
 }
 
@@ -191,6 +198,91 @@ int SSLWrapper::getError(SSL* ssl, int returnCode)
     return SSL_get_error(ssl, returnCode);
 }
 
+bool SSLWrapper::getRecordKeys(SSL* ssl, RecordKeys& keys)
+{
+#if (OPENSSL_VERSION_NUMBER < 0x10101000L)
+    return false;
+#else
+    const auto cipher = SSL_get_current_cipher(ssl);
+
+    if(SSL_version(ssl) != TLS1_2_VERSION || cipher == nullptr)
+    {
+        return false;
+    }
+
+    const auto cipherNid = SSL_CIPHER_get_cipher_nid(cipher);
+    size_t fixedIVSize = 0;
+
+    if(cipherNid == NID_aes_128_gcm || cipherNid == NID_aes_256_gcm)
+    {
+        fixedIVSize = 4;
+        keys.explicitNonceSize = 8;
+    }
+    else if(cipherNid == NID_chacha20_poly1305)
+    {
+        fixedIVSize = 12;
+        keys.explicitNonceSize = 0;
+    }
+    else
+    {
+        return false;
+    }
+
+    keys.cipher = EVP_get_cipherbynid(cipherNid);
+
+    if(keys.cipher == nullptr)
+    {
+        return false;
+    }
+
+    uint8_t masterKey[SSL_MAX_MASTER_KEY_LENGTH];
+    const auto masterKeySize = SSL_SESSION_get_master_key(SSL_get_session(ssl), masterKey, sizeof(masterKey));
+    uint8_t clientRandom[SSL3_RANDOM_SIZE];
+    uint8_t serverRandom[SSL3_RANDOM_SIZE];
+    SSL_get_client_random(ssl, clientRandom, sizeof(clientRandom));
+    SSL_get_server_random(ssl, serverRandom, sizeof(serverRandom));
+
+    // RFC 5246 6.3, AEAD suites have no MAC keys
+    const size_t keySize = EVP_CIPHER_key_length(keys.cipher);
+    common::Data keyBlock(2 * (keySize + fixedIVSize));
+    size_t keyBlockSize = keyBlock.size();
+    static const std::string cKeyExpansionLabel("key expansion");
+
+    auto context = EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr);
+    const bool derived = context != nullptr
+            && EVP_PKEY_derive_init(context) == 1
+            && EVP_PKEY_CTX_set_tls1_prf_md(context, SSL_CIPHER_get_handshake_digest(cipher)) == 1
+            && EVP_PKEY_CTX_set1_tls1_prf_secret(context, masterKey, masterKeySize) == 1
+            && EVP_PKEY_CTX_add1_tls1_prf_seed(context, reinterpret_cast<const unsigned char*>(cKeyExpansionLabel.c_str()), cKeyExpansionLabel.size()) == 1
+            && EVP_PKEY_CTX_add1_tls1_prf_seed(context, serverRandom, sizeof(serverRandom)) == 1
+            && EVP_PKEY_CTX_add1_tls1_prf_seed(context, clientRandom, sizeof(clientRandom)) == 1
+            && EVP_PKEY_derive(context, keyBlock.data(), &keyBlockSize) == 1;
+
+    EVP_PKEY_CTX_free(context);
+    OPENSSL_cleanse(masterKey, sizeof(masterKey));
+
+    if(!derived)
+    {
+        OPENSSL_cleanse(keyBlock.data(), keyBlock.size());
+        return false;
+    }
+
+    const auto clientKey = keyBlock.begin();
+    const auto serverKey = clientKey + keySize;
+    const auto clientIV = serverKey + keySize;
+    const auto serverIV = clientIV + fixedIVSize;
+    const bool server = SSL_is_server(ssl) == 1;
+
+    keys.writeKey.assign(server ? serverKey : clientKey, (server ? serverKey : clientKey) + keySize);
+    keys.readKey.assign(server ? clientKey : serverKey, (server ? clientKey : serverKey) + keySize);
+    keys.writeIV.assign(server ? serverIV : clientIV, (server ? serverIV : clientIV) + fixedIVSize);
+    keys.readIV.assign(server ? clientIV : serverIV, (server ? clientIV : serverIV) + fixedIVSize);
+    OPENSSL_cleanse(keyBlock.data(), keyBlock.size());
+
+    return true;
+#endif
+}
+
 }
 }
 }
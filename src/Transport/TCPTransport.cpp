@@ -25,8 +25,8 @@ namespace aasdk
 namespace transport
 {
 
-TCPTransport::TCPTransport(boost::asio::io_service& ioService, tcp::ITCPEndpoint::Pointer tcpEndpoint)
-    : Transport(ioService)
+TCPTransport::TCPTransport(boost::asio::io_service& ioService, tcp::ITCPEndpoint::Pointer tcpEndpoint, size_t receiveBufferLimit)
+    : Transport(ioService, receiveBufferLimit)
     , tcpEndpoint_(std::move(tcpEndpoint))
 {
 
@@ -39,7 +39,7 @@ void TCPTransport::enqueueReceive(common::DataBuffer buffer)
             this->receiveHandler(bytesTransferred);
         },
         [this, self = this->shared_from_this()](auto e) {
-            this->rejectReceivePromises(e);
+            this->receiveErrorHandler(e);
         });
 
     tcpEndpoint_->receive(buffer, std::move(receivePromise));
@@ -56,11 +56,12 @@ void TCPTransport::enqueueSend(SendQueue::iterator queueElement)
         this->sendHandler(queueElement, e);
     });
 
-    tcpEndpoint_->send(common::DataConstBuffer(queueElement->first), std::move(sendPromise));
+    tcpEndpoint_->send(common::createBufferSequence(queueElement->first), std::move(sendPromise));
 }
 
 void TCPTransport::stop()
 {
+    Transport::stop();
     tcpEndpoint_->stop();
 }
 
@@ -75,12 +76,7 @@ void TCPTransport::sendHandler(SendQueue::iterator queueElement, const error::Er
         queueElement->second->reject(e);
     }
 
-    sendQueue_.erase(queueElement);
-
-    if(!sendQueue_.empty())
-    {
-        this->enqueueSend(sendQueue_.begin());
-    }
+    this->finishSend(queueElement);
 }
 
 }
@@ -35,6 +35,8 @@ using ::testing::ReturnRef;
 using ::testing::SaveArg;
 using ::testing::_;
 using ::testing::AtLeast;
+using ::testing::Eq;
+using ::testing::Invoke;
 
 class TCPTransportUnitTest
 {
@@ -77,12 +79,32 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveAtOnce, TCPTransportUnitTest)
     common::Data expectedData(receiveSize, 0x5E);
     std::copy(expectedData.begin(), expectedData.end(), dataBuffer.data);
 
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(expectedData)).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
     tcpEndpointPromise->resolve(receiveSize);
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveAvailable, TCPTransportUnitTest)
+{
+    tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
+    common::DataBuffer dataBuffer;
+    EXPECT_CALL(tcpEndpointMock_, receive(_, _)).WillOnce(DoAll(SaveArg<0>(&dataBuffer), SaveArg<1>(&tcpEndpointPromise)));
+
+    auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_));
+    transport->receiveAvailable(std::move(receivePromise_));
+    ioService_.run();
+    ioService_.reset();
+
+    common::Data expectedData(123, 0x5E);
+    std::copy(expectedData.begin(), expectedData.end(), dataBuffer.data);
+
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+    tcpEndpointPromise->resolve(expectedData.size());
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveInPieces, TCPTransportUnitTest)
 {
     const size_t stepsCount = 100;
@@ -98,7 +120,7 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveInPieces, TCPTransportUnitTest)
             .WillRepeatedly(DoAll(SaveArg<0>(&dataBuffer), SaveArg<1>(&tcpEndpointPromise)));
 
     common::Data expectedData(receiveSize, 0x5E);
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(expectedData)).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
 
     for(size_t i = 0; i < stepsCount; ++i)
@@ -142,11 +164,11 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_OnlyOneReceiveAtATime, TCPTransportUnitTest
     ioService_.reset();
 
     common::Data expectedData(stepSize, 0x5E);
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(expectedData)).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
 
     common::Data secondExpectedData(stepSize, 0x5F);
-    EXPECT_CALL(secondPromiseHandlerMock, onResolve(secondExpectedData)).Times(1);
+    EXPECT_CALL(secondPromiseHandlerMock, onResolve(Eq(secondExpectedData))).Times(1);
     EXPECT_CALL(secondPromiseHandlerMock, onReject(_)).Times(0);
 
     tcpEndpointPromise->resolve(receiveSize);
@@ -177,11 +199,67 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveError, TCPTransportUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveExceedingBufferLimit, TCPTransportUnitTest)
+{
+    const size_t receiveBufferLimit = 64 * 1024;
+    EXPECT_CALL(tcpEndpointMock_, receive(_, _)).Times(AtLeast(0))
+            .WillRepeatedly(Invoke([](auto buffer, auto promise) { promise->resolve(buffer.size); }));
+
+    auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_, receiveBufferLimit));
+    transport->receive(receiveBufferLimit + 1, std::move(receivePromise_));
+
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(0);
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(error::Error(error::ErrorCode::DATA_SINK_COMMIT_OVERFLOW)));
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(TCPTransport_ReceiveWaitsForReleasedData, TCPTransportUnitTest)
+{
+    const size_t receiveBufferLimit = 64 * 1024;
+    const size_t receiveSize = receiveBufferLimit / 4;
+
+    EXPECT_CALL(tcpEndpointMock_, receive(_, _)).Times(4)
+            .WillRepeatedly(Invoke([](auto buffer, auto promise) { promise->resolve(buffer.size); }));
+
+    auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_, receiveBufferLimit));
+
+    std::vector<common::DataSlice> receivedData;
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(_)).Times(4).WillRepeatedly(Invoke([&](auto data) { receivedData.push_back(data); }));
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+
+    for(size_t i = 0; i < 4; ++i)
+    {
+        auto promise = ITransport::ReceivePromise::defer(ioService_);
+        promise->then(std::bind(&TransportReceivePromiseHandlerMock::onResolve, &receivePromiseHandlerMock_, std::placeholders::_1),
+                      std::bind(&TransportReceivePromiseHandlerMock::onReject, &receivePromiseHandlerMock_, std::placeholders::_1));
+        transport->receive(receiveSize, std::move(promise));
+        ioService_.run();
+        ioService_.reset();
+    }
+
+    // whole buffer is referenced by received data, transport must not read any further
+    TransportReceivePromiseHandlerMock fifthPromiseHandlerMock;
+    auto fifthPromise = ITransport::ReceivePromise::defer(ioService_);
+    fifthPromise->then(std::bind(&TransportReceivePromiseHandlerMock::onResolve, &fifthPromiseHandlerMock, std::placeholders::_1),
+                       std::bind(&TransportReceivePromiseHandlerMock::onReject, &fifthPromiseHandlerMock, std::placeholders::_1));
+    transport->receive(receiveSize, std::move(fifthPromise));
+    ioService_.poll();
+    ioService_.reset();
+    BOOST_TEST(transport->getReceiveBufferHighWaterMark() == receiveBufferLimit);
+
+    EXPECT_CALL(tcpEndpointMock_, receive(_, _)).WillOnce(Invoke([](auto buffer, auto promise) { promise->resolve(buffer.size); }));
+    EXPECT_CALL(fifthPromiseHandlerMock, onResolve(_));
+    EXPECT_CALL(fifthPromiseHandlerMock, onReject(_)).Times(0);
+    // releasing the slices wakes the transport up, nothing has to expire first
+    receivedData.clear();
+    ioService_.poll();
+}
+
 BOOST_FIXTURE_TEST_CASE(TCPTransport_Send, TCPTransportUnitTest)
 {
     tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
-    common::DataConstBuffer buffer;
-    EXPECT_CALL(tcpEndpointMock_, send(_, _)).WillOnce(DoAll(SaveArg<0>(&buffer), SaveArg<1>(&tcpEndpointPromise)));
+    common::DataConstBufferSequence buffers;
+    EXPECT_CALL(tcpEndpointMock_, send(_, _)).WillOnce(DoAll(SaveArg<0>(&buffers), SaveArg<1>(&tcpEndpointPromise)));
 
     auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_));
     const common::Data expectedData(1000, 0x5E);
@@ -189,7 +267,7 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_Send, TCPTransportUnitTest)
     ioService_.run();
     ioService_.reset();
 
-    common::Data actualData(buffer.cdata, buffer.cdata + buffer.size);
+    common::Data actualData(buffers[0].cdata, buffers[0].cdata + buffers[0].size);
     BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
 
     EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
@@ -198,11 +276,34 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_Send, TCPTransportUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(TCPTransport_SendSequence, TCPTransportUnitTest)
+{
+    tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
+    common::DataConstBufferSequence buffers;
+    EXPECT_CALL(tcpEndpointMock_, send(_, _)).WillOnce(DoAll(SaveArg<0>(&buffers), SaveArg<1>(&tcpEndpointPromise)));
+
+    auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_));
+    const common::Data head(4, 0x5E);
+    const common::DataSlice payload(common::Data(1000, 0x5F));
+    transport->send(common::DataSequence(head, payload), std::move(sendPromise_));
+    ioService_.run();
+    ioService_.reset();
+
+    common::Data actualHead(buffers[0].cdata, buffers[0].cdata + buffers[0].size);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualHead.begin(), actualHead.end(), head.begin(), head.end());
+    BOOST_TEST((buffers[1] == common::DataConstBuffer(payload)));
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    tcpEndpointPromise->resolve(head.size() + payload.size);
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(TCPTransport_OnlyOneSendAtATime, TCPTransportUnitTest)
 {
     tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
-    common::DataConstBuffer buffer;
-    EXPECT_CALL(tcpEndpointMock_, send(_, _)).Times(2).WillRepeatedly(DoAll(SaveArg<0>(&buffer), SaveArg<1>(&tcpEndpointPromise)));
+    common::DataConstBufferSequence buffers;
+    EXPECT_CALL(tcpEndpointMock_, send(_, _)).Times(2).WillRepeatedly(DoAll(SaveArg<0>(&buffers), SaveArg<1>(&tcpEndpointPromise)));
 
     auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_));
     const common::Data expectedData1(1000, 0x5E);
@@ -221,7 +322,7 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_OnlyOneSendAtATime, TCPTransportUnitTest)
     ioService_.run();
     ioService_.reset();
 
-    common::Data actualData1(buffer.cdata, buffer.cdata + buffer.size);
+    common::Data actualData1(buffers[0].cdata, buffers[0].cdata + buffers[0].size);
     BOOST_CHECK_EQUAL_COLLECTIONS(actualData1.begin(), actualData1.end(), expectedData1.begin(), expectedData1.end());
 
     EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
@@ -230,7 +331,7 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_OnlyOneSendAtATime, TCPTransportUnitTest)
     ioService_.run();
     ioService_.reset();
 
-    common::Data actualData2(buffer.cdata, buffer.cdata + buffer.size);
+    common::Data actualData2(buffers[0].cdata, buffers[0].cdata + buffers[0].size);
     BOOST_CHECK_EQUAL_COLLECTIONS(actualData2.begin(), actualData2.end(), expectedData2.begin(), expectedData2.end());
 
     EXPECT_CALL(secondSendPromiseHandlerMock, onReject(_)).Times(0);
@@ -239,6 +340,86 @@ BOOST_FIXTURE_TEST_CASE(TCPTransport_OnlyOneSendAtATime, TCPTransportUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(TCPTransport_CoalesceQueuedSends, TCPTransportUnitTest)
+{
+    tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
+    common::DataConstBufferSequence buffers;
+    EXPECT_CALL(tcpEndpointMock_, send(_, _)).Times(2).WillRepeatedly(DoAll(SaveArg<0>(&buffers), SaveArg<1>(&tcpEndpointPromise)));
+
+    auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_));
+    transport->setSendCoalescing(16384, std::chrono::microseconds(0));
+
+    const common::Data expectedData1(1000, 0x5E);
+    transport->send(expectedData1, std::move(sendPromise_));
+
+    auto secondSendPromise = ITransport::SendPromise::defer(ioService_);
+    TransportSendPromiseHandlerMock secondSendPromiseHandlerMock;
+    secondSendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &secondSendPromiseHandlerMock),
+                           std::bind(&TransportSendPromiseHandlerMock::onReject, &secondSendPromiseHandlerMock, std::placeholders::_1));
+    transport->send(common::Data(100, 0x5F), std::move(secondSendPromise));
+
+    auto thirdSendPromise = ITransport::SendPromise::defer(ioService_);
+    TransportSendPromiseHandlerMock thirdSendPromiseHandlerMock;
+    thirdSendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &thirdSendPromiseHandlerMock),
+                          std::bind(&TransportSendPromiseHandlerMock::onReject, &thirdSendPromiseHandlerMock, std::placeholders::_1));
+    transport->send(common::DataSequence(common::Data(2, 0x60), common::DataSlice(common::Data(200, 0x61))), std::move(thirdSendPromise));
+    ioService_.run();
+    ioService_.reset();
+
+    common::Data actualData1(buffers[0].cdata, buffers[0].cdata + buffers[0].size);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData1.begin(), actualData1.end(), expectedData1.begin(), expectedData1.end());
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    tcpEndpointPromise->resolve(expectedData1.size());
+    ioService_.run();
+    ioService_.reset();
+
+    common::Data expectedData2(100, 0x5F);
+    expectedData2.resize(102, 0x60);
+    expectedData2.resize(302, 0x61);
+    common::Data actualData2(buffers[0].cdata, buffers[0].cdata + buffers[0].size);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData2.begin(), actualData2.end(), expectedData2.begin(), expectedData2.end());
+    BOOST_TEST((buffers[1] == nullptr));
+
+    EXPECT_CALL(secondSendPromiseHandlerMock, onReject(_)).Times(0);
+    EXPECT_CALL(secondSendPromiseHandlerMock, onResolve());
+    EXPECT_CALL(thirdSendPromiseHandlerMock, onReject(_)).Times(0);
+    EXPECT_CALL(thirdSendPromiseHandlerMock, onResolve());
+    tcpEndpointPromise->resolve(expectedData2.size());
+    ioService_.run();
+
+    const auto statistics = transport->getSendStatistics();
+    BOOST_TEST(statistics.frames == 3u);
+    BOOST_TEST(statistics.transfers == 2u);
+}
+
+BOOST_FIXTURE_TEST_CASE(TCPTransport_HoldSendForCoalescing, TCPTransportUnitTest)
+{
+    tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
+    common::DataConstBufferSequence buffers;
+    EXPECT_CALL(tcpEndpointMock_, send(_, _)).WillOnce(DoAll(SaveArg<0>(&buffers), SaveArg<1>(&tcpEndpointPromise)));
+
+    auto transport(std::make_shared<TCPTransport>(ioService_, tcpEndpoint_));
+    transport->setSendCoalescing(16384, std::chrono::microseconds(200));
+    transport->send(common::Data(10, 0x5E), std::move(sendPromise_));
+
+    auto secondSendPromise = ITransport::SendPromise::defer(ioService_);
+    TransportSendPromiseHandlerMock secondSendPromiseHandlerMock;
+    secondSendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &secondSendPromiseHandlerMock),
+                           std::bind(&TransportSendPromiseHandlerMock::onReject, &secondSendPromiseHandlerMock, std::placeholders::_1));
+    transport->send(common::Data(20, 0x5F), std::move(secondSendPromise));
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_TEST(buffers[0].size == 30u);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    EXPECT_CALL(secondSendPromiseHandlerMock, onResolve());
+    tcpEndpointPromise->resolve(30);
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(TCPTransport_SendError, TCPTransportUnitTest)
 {
     tcp::ITCPEndpoint::Promise::Pointer tcpEndpointPromise;
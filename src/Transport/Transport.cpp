@@ -25,11 +25,45 @@ namespace aasdk
 namespace transport
 {
 
-Transport::Transport(boost::asio::io_service& ioService)
-    : receiveStrand_(ioService)
+Transport::Transport(boost::asio::io_service& ioService, size_t receiveBufferLimit)
+    : receivedDataSink_(receiveBufferLimit)
+    , receiveStrand_(ioService)
+    , isWaitingForReceiveBuffer_(false)
+    , receiveQueueDepth_(1)
+    , pendingReceivesCount_(0)
     , sendStrand_(ioService)
+    , sendQueueDepth_(1)
+    , pendingSendsCount_(0)
+    , sendHoldTimer_(ioService)
+    , isSendHeld_(false)
+    , maxCoalescedSize_(0)
+    , maxCoalescingLatency_(0)
+    , sentFramesCount_(0)
+    , transfersCount_(0)
 {}
 
+Transport::Transport(boost::asio::io_service& ioService, IDataSinkStorage::Pointer receiveStorage)
+    : receivedDataSink_(std::move(receiveStorage))
+    , receiveStrand_(ioService)
+    , isWaitingForReceiveBuffer_(false)
+    , receiveQueueDepth_(1)
+    , pendingReceivesCount_(0)
+    , sendStrand_(ioService)
+    , sendQueueDepth_(1)
+    , pendingSendsCount_(0)
+    , sendHoldTimer_(ioService)
+    , isSendHeld_(false)
+    , maxCoalescedSize_(0)
+    , maxCoalescingLatency_(0)
+    , sentFramesCount_(0)
+    , transfersCount_(0)
+{}
+
+void Transport::receiveAvailable(ReceivePromise::Pointer promise)
+{
+    this->receive(cAvailableSize, std::move(promise));
+}
+
 void Transport::receive(size_t size, ReceivePromise::Pointer promise)
 {
     receiveStrand_.dispatch([this, self = this->shared_from_this(), size, promise = std::move(promise)]() mutable {
@@ -53,6 +87,7 @@ void Transport::receiveHandler(size_t bytesTransferred)
 {
     try
     {
+        --pendingReceivesCount_;
         receivedDataSink_.commit(bytesTransferred);
         this->distributeReceivedData();
     }
@@ -62,20 +97,47 @@ void Transport::receiveHandler(size_t bytesTransferred)
     }
 }
 
+void Transport::receiveErrorHandler(const error::Error& e)
+{
+    --pendingReceivesCount_;
+    receivedDataSink_.commit(0);
+    this->rejectReceivePromises(e);
+}
+
 void Transport::distributeReceivedData()
 {
     for(auto queueElement = receiveQueue_.begin(); queueElement != receiveQueue_.end();)
     {
-        if(receivedDataSink_.getAvailableSize() < queueElement->first)
+        // data available at once is handed out up to where it can still be sliced without a copy
+        const bool isAvailableRequest = queueElement->first == cAvailableSize;
+        const auto size = isAvailableRequest ? receivedDataSink_.getContiguousSize() : queueElement->first;
+
+        if(isAvailableRequest ? size == 0 : receivedDataSink_.getAvailableSize() < size)
         {
-            auto buffer = receivedDataSink_.fill();
-            this->enqueueReceive(std::move(buffer));
+            while(pendingReceivesCount_ < receiveQueueDepth_)
+            {
+                auto buffer = receivedDataSink_.fill();
+
+                if(buffer == nullptr)
+                {
+                    // outstanding receives will bring the distribution back, otherwise wait for released space
+                    if(pendingReceivesCount_ == 0 && !isWaitingForReceiveBuffer_)
+                    {
+                        this->waitForReceiveBuffer();
+                    }
+
+                    break;
+                }
+
+                ++pendingReceivesCount_;
+                this->enqueueReceive(std::move(buffer));
+            }
 
             break;
         }
         else
         {
-            auto data(receivedDataSink_.consume(queueElement->first));
+            auto data(receivedDataSink_.consume(size));
             queueElement->second->resolve(std::move(data));
             queueElement = receiveQueue_.erase(queueElement);
         }
@@ -92,18 +154,193 @@ void Transport::rejectReceivePromises(const error::Error& e)
     receiveQueue_.clear();
 }
 
-void Transport::send(common::Data data, SendPromise::Pointer promise)
+void Transport::waitForReceiveBuffer()
+{
+    // receive buffer limit is reached, stop reading until consumers release enough slices
+    isWaitingForReceiveBuffer_ = true;
+
+    std::weak_ptr<Transport> weakSelf = this->shared_from_this();
+    receivedDataSink_.notifyOnRelease([this, weakSelf]() {
+        // slices are released on any thread and may outlive the transport
+        if(auto self = weakSelf.lock())
+        {
+            receiveStrand_.post([this, self = std::move(self)]() {
+                if(!isWaitingForReceiveBuffer_)
+                {
+                    return;
+                }
+
+                isWaitingForReceiveBuffer_ = false;
+
+                try
+                {
+                    this->distributeReceivedData();
+                }
+                catch(const error::Error& e)
+                {
+                    this->rejectReceivePromises(e);
+                }
+            });
+        }
+    });
+}
+
+size_t Transport::getReceiveBufferHighWaterMark() const
+{
+    return receivedDataSink_.getHighWaterMark();
+}
+
+void Transport::stop()
+{
+    receiveStrand_.dispatch([this, self = this->shared_from_this()]() {
+        if(isWaitingForReceiveBuffer_)
+        {
+            isWaitingForReceiveBuffer_ = false;
+            receivedDataSink_.cancelReleaseNotification();
+            this->rejectReceivePromises(error::Error(error::ErrorCode::OPERATION_ABORTED));
+        }
+    });
+
+    sendStrand_.dispatch([this, self = this->shared_from_this()]() {
+        if(isSendHeld_)
+        {
+            isSendHeld_ = false;
+
+            for(auto& queueElement : sendQueue_)
+            {
+                queueElement.second->reject(error::Error(error::ErrorCode::OPERATION_ABORTED));
+            }
+
+            sendQueue_.clear();
+        }
+
+        sendHoldTimer_.cancel();
+    });
+}
+
+void Transport::send(common::DataSequence data, SendPromise::Pointer promise)
 {
     sendStrand_.dispatch([this, self = this->shared_from_this(), data = std::move(data), promise = std::move(promise)]() mutable {
         sendQueue_.emplace_back(std::make_pair(std::move(data), std::move(promise)));
+        sentFramesCount_.fetch_add(1, std::memory_order_relaxed);
 
-        if(sendQueue_.size() == 1)
+        if(isSendHeld_)
         {
-            this->enqueueSend(sendQueue_.begin());
+            if(this->getQueuedSendSize() >= maxCoalescedSize_)
+            {
+                isSendHeld_ = false;
+                sendHoldTimer_.cancel();
+                this->sendNext();
+            }
         }
+        else if(pendingSendsCount_ == 0 && maxCoalescedSize_ > 0 && maxCoalescingLatency_.count() > 0)
+        {
+            this->holdSend();
+        }
+        else
+        {
+            this->sendNext();
+        }
+    });
+}
+
+void Transport::setSendCoalescing(size_t maxTransferSize, std::chrono::microseconds maxLatency)
+{
+    sendStrand_.dispatch([this, self = this->shared_from_this(), maxTransferSize, maxLatency]() {
+        maxCoalescedSize_ = maxTransferSize;
+        maxCoalescingLatency_ = maxLatency;
     });
 }
 
+Transport::SendStatistics Transport::getSendStatistics() const
+{
+    return {sentFramesCount_.load(std::memory_order_relaxed), transfersCount_.load(std::memory_order_relaxed)};
+}
+
+void Transport::sendNext()
+{
+    // elements in flight are always at the front of the queue
+    while(pendingSendsCount_ < sendQueueDepth_ && pendingSendsCount_ < sendQueue_.size())
+    {
+        auto queueElement = std::next(sendQueue_.begin(), pendingSendsCount_);
+        this->coalesceSendQueue(queueElement);
+
+        ++pendingSendsCount_;
+        transfersCount_.fetch_add(1, std::memory_order_relaxed);
+        this->enqueueSend(queueElement);
+    }
+}
+
+void Transport::finishSend(SendQueue::iterator queueElement)
+{
+    sendQueue_.erase(queueElement);
+    --pendingSendsCount_;
+    this->sendNext();
+}
+
+void Transport::coalesceSendQueue(SendQueue::iterator queueElement)
+{
+    auto nextQueueElement = std::next(queueElement);
+
+    if(nextQueueElement == sendQueue_.end() || queueElement->first.size() + nextQueueElement->first.size() > maxCoalescedSize_)
+    {
+        return;
+    }
+
+    auto& data = queueElement->first;
+    common::copy(data.head, common::DataConstBuffer(data.payload));
+    data.payload = common::DataSlice();
+
+    std::vector<SendPromise::Pointer> promises{std::move(queueElement->second)};
+
+    while(nextQueueElement != sendQueue_.end() && data.size() + nextQueueElement->first.size() <= maxCoalescedSize_)
+    {
+        common::copy(data.head, common::DataConstBuffer(nextQueueElement->first.head));
+        common::copy(data.head, common::DataConstBuffer(nextQueueElement->first.payload));
+        promises.push_back(std::move(nextQueueElement->second));
+        nextQueueElement = sendQueue_.erase(nextQueueElement);
+    }
+
+    queueElement->second = SendPromise::defer(sendStrand_);
+    queueElement->second->then([promises]() {
+            for(const auto& promise : promises)
+            {
+                promise->resolve();
+            }
+        },
+        [promises](const error::Error& e) {
+            for(const auto& promise : promises)
+            {
+                promise->reject(e);
+            }
+        });
+}
+
+void Transport::holdSend()
+{
+    isSendHeld_ = true;
+    sendHoldTimer_.expires_from_now(maxCoalescingLatency_);
+    sendHoldTimer_.async_wait(sendStrand_.wrap([this, self = this->shared_from_this()](const boost::system::error_code& ec) {
+        if(ec != boost::asio::error::operation_aborted && isSendHeld_)
+        {
+            isSendHeld_ = false;
+            this->sendNext();
+        }
+    }));
+}
+
+size_t Transport::getQueuedSendSize() const
+{
+    size_t size = 0;
+
+    for(const auto& queueElement : sendQueue_)
+    {
+        size += queueElement.first.size();
+    }
+
+    return size;
+}
+
 }
 }
 }
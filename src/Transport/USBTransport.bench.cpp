@@ -0,0 +1,195 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <f1x/aasdk/USB/UT/USBWrapper.mock.hpp>
+#include <f1x/aasdk/USB/USBEndpoint.hpp>
+#include <f1x/aasdk/USB/IAOAPDevice.hpp>
+#include <f1x/aasdk/Transport/USBTransport.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace transport
+{
+namespace bench
+{
+
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+// Bus moves bulk OUT data at a fixed rate and reports every completion after the host controller latency.
+class SimulatedBus
+{
+public:
+    SimulatedBus(double bytesPerSecond, std::chrono::microseconds completionLatency)
+        : work_(ioService_)
+        , thread_([this]() { ioService_.run(); })
+        , bytesPerSecond_(bytesPerSecond)
+        , completionLatency_(completionLatency)
+        , busyUntil_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~SimulatedBus()
+    {
+        ioService_.stop();
+        thread_.join();
+    }
+
+    int submit(libusb_transfer* transfer)
+    {
+        ioService_.post([this, transfer]() {
+            const auto now = std::chrono::steady_clock::now();
+            const auto transferTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(transfer->length / bytesPerSecond_));
+            busyUntil_ = std::max(busyUntil_, now) + transferTime;
+
+            auto timer = std::make_shared<boost::asio::steady_timer>(ioService_, busyUntil_ + completionLatency_);
+            timer->async_wait([timer, transfer](const boost::system::error_code&) {
+                transfer->status = LIBUSB_TRANSFER_COMPLETED;
+                transfer->actual_length = transfer->length;
+                transfer->callback(transfer);
+            });
+        });
+
+        return 0;
+    }
+
+private:
+    boost::asio::io_service ioService_;
+    boost::asio::io_service::work work_;
+    std::thread thread_;
+    double bytesPerSecond_;
+    std::chrono::microseconds completionLatency_;
+    std::chrono::steady_clock::time_point busyUntil_;
+};
+
+class AOAPDevice: public usb::IAOAPDevice
+{
+public:
+    AOAPDevice(usb::IUSBEndpoint::Pointer inEndpoint, usb::IUSBEndpoint::Pointer outEndpoint)
+        : inEndpoint_(std::move(inEndpoint))
+        , outEndpoint_(std::move(outEndpoint))
+    {
+    }
+
+    usb::IUSBEndpoint& getInEndpoint() override
+    {
+        return *inEndpoint_;
+    }
+
+    usb::IUSBEndpoint& getOutEndpoint() override
+    {
+        return *outEndpoint_;
+    }
+
+private:
+    usb::IUSBEndpoint::Pointer inEndpoint_;
+    usb::IUSBEndpoint::Pointer outEndpoint_;
+};
+
+double measureSendThroughput(size_t sendQueueDepth)
+{
+    static constexpr size_t cFramesCount = 5000;
+    // microphone sized frames interleaved with touch events
+    static const common::Data cMicrophoneFrame(2048 + 8, 0x5E);
+    static const common::Data cTouchFrame(32, 0x5F);
+
+    SimulatedBus bus(35.0 * 1024 * 1024, std::chrono::microseconds(125));
+    NiceMock<usb::ut::USBWrapperMock> usbWrapper;
+
+    ON_CALL(usbWrapper, allocTransfer(_)).WillByDefault(Invoke([](int) {
+        return static_cast<libusb_transfer*>(calloc(1, sizeof(libusb_transfer)));
+    }));
+    ON_CALL(usbWrapper, freeTransfer(_)).WillByDefault(Invoke([](libusb_transfer* transfer) { free(transfer); }));
+    ON_CALL(usbWrapper, fillBulkTransfer(_, _, _, _, _, _, _, _)).WillByDefault(Invoke([](libusb_transfer* transfer, const usb::DeviceHandle&, unsigned char endpoint,
+                                                                                          unsigned char* buffer, int length, libusb_transfer_cb_fn callback, void* userData, unsigned int timeout) {
+        transfer->endpoint = endpoint;
+        transfer->buffer = buffer;
+        transfer->length = length;
+        transfer->callback = callback;
+        transfer->user_data = userData;
+        transfer->timeout = timeout;
+    }));
+    ON_CALL(usbWrapper, submitTransfer(_)).WillByDefault(Invoke(&bus, &SimulatedBus::submit));
+    ON_CALL(usbWrapper, cancelTransfer(_)).WillByDefault(Return(0));
+
+    boost::asio::io_service ioService;
+    boost::asio::io_service::work work(ioService);
+    std::thread thread([&ioService]() { ioService.run(); });
+
+    {
+        auto inEndpoint = std::make_shared<usb::USBEndpoint>(usbWrapper, ioService, usb::DeviceHandle(), 0x81);
+        auto outEndpoint = std::make_shared<usb::USBEndpoint>(usbWrapper, ioService, usb::DeviceHandle(), 0x01);
+        auto transport = std::make_shared<USBTransport>(ioService, std::make_shared<AOAPDevice>(inEndpoint, outEndpoint));
+        transport->setSendQueueDepth(sendQueueDepth);
+
+        std::promise<void> done;
+        std::atomic<size_t> sentCount(0);
+        size_t sentSize = 0;
+        const auto begin = std::chrono::steady_clock::now();
+
+        for(size_t i = 0; i < cFramesCount; ++i)
+        {
+            const auto& frame = i % 4 == 3 ? cTouchFrame : cMicrophoneFrame;
+            sentSize += frame.size();
+
+            auto promise = ITransport::SendPromise::defer(ioService);
+            promise->then([&]() {
+                    if(++sentCount == cFramesCount)
+                    {
+                        done.set_value();
+                    }
+                },
+                [](const error::Error& e) { BOOST_FAIL(e.what()); });
+
+            transport->send(frame, std::move(promise));
+        }
+
+        done.get_future().wait();
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - begin;
+        transport->stop();
+
+        ioService.stop();
+        thread.join();
+
+        return sentSize / duration.count() / (1024 * 1024);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(USBTransport_PipelinedSendThroughput)
+{
+    for(size_t depth : {1, 2, 4, 8})
+    {
+        std::cout << "usb send queue depth " << depth << ":       " << measureSendThroughput(depth) << " MB/s" << std::endl;
+    }
+}
+
+}
+}
+}
+}
@@ -16,7 +16,11 @@
 *  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <f1x/aasdk/Transport/USBTransport.hpp>
+#include <f1x/aasdk/Transport/USBDataSinkStorage.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+#include <f1x/aasdk/Common/Log.hpp>
 
 namespace f1x
 {
@@ -25,9 +29,16 @@ namespace aasdk
 namespace transport
 {
 
-USBTransport::USBTransport(boost::asio::io_service& ioService, usb::IAOAPDevice::Pointer aoapDevice)
-    : Transport(ioService)
+USBTransport::USBTransport(boost::asio::io_service& ioService, usb::IAOAPDevice::Pointer aoapDevice, size_t receiveBufferLimit)
+    : Transport(ioService, receiveBufferLimit)
     , aoapDevice_(std::move(aoapDevice))
+    , usbWrapper_(nullptr)
+{}
+
+USBTransport::USBTransport(boost::asio::io_service& ioService, usb::IAOAPDevice::Pointer aoapDevice, usb::IUSBWrapper& usbWrapper, size_t receiveBufferSize)
+    : Transport(ioService, createReceiveStorage(usbWrapper, aoapDevice->getInEndpoint().getDeviceHandle(), receiveBufferSize))
+    , aoapDevice_(std::move(aoapDevice))
+    , usbWrapper_(&usbWrapper)
 {}
 
 void USBTransport::enqueueReceive(common::DataBuffer buffer)
@@ -37,7 +48,7 @@ void USBTransport::enqueueReceive(common::DataBuffer buffer)
             this->receiveHandler(bytesTransferred);
         },
         [this, self = this->shared_from_this()](auto e) {
-            this->rejectReceivePromises(e);
+            this->receiveErrorHandler(e);
         });
 
     aoapDevice_->getInEndpoint().bulkTransfer(buffer, cReceiveTimeoutMs, std::move(usbEndpointPromise));
@@ -45,48 +56,148 @@ void USBTransport::enqueueReceive(common::DataBuffer buffer)
 
 void USBTransport::enqueueSend(SendQueue::iterator queueElement)
 {
-    this->doSend(queueElement, 0);
+    auto& data = queueElement->first;
+    auto sendBuffer = this->acquireSendBuffer(data.size());
+
+    // bulk transfer is made from a single buffer
+    if(sendBuffer != nullptr)
+    {
+        const auto payload = sendBuffer->getData() + data.head.size();
+        std::copy(data.head.begin(), data.head.end(), sendBuffer->getData());
+        std::copy(data.payload.cdata, data.payload.cdata + data.payload.size, payload);
+    }
+    else if(data.payload.size > 0 && !data.head.empty())
+    {
+        common::copy(data.head, common::DataConstBuffer(data.payload));
+        data.payload = common::DataSlice();
+    }
+
+    this->doSend(queueElement, std::move(sendBuffer), 0);
 }
 
-void USBTransport::doSend(SendQueue::iterator queueElement, common::Data::size_type offset)
+void USBTransport::doSend(SendQueue::iterator queueElement, usb::USBDeviceMemory::Pointer sendBuffer, common::Data::size_type offset)
 {
+    auto& data = queueElement->first;
+    common::DataBuffer buffer;
+
+    if(sendBuffer != nullptr)
+    {
+        buffer = common::DataBuffer(sendBuffer->getData(), data.size(), offset);
+    }
+    else if(data.head.empty())
+    {
+        // frame was put together in front of the message payload, OUT transfer only reads from it
+        buffer = common::DataBuffer(const_cast<common::Data::value_type*>(data.payload.cdata), data.payload.size, offset);
+    }
+    else
+    {
+        buffer = common::DataBuffer(data.head, offset);
+    }
+
     auto usbEndpointPromise = usb::IUSBEndpoint::Promise::defer(sendStrand_);
-    usbEndpointPromise->then([this, self = this->shared_from_this(), queueElement, offset](size_t bytesTransferred) mutable {
-            this->sendHandler(queueElement, offset, bytesTransferred);
+    usbEndpointPromise->then([this, self = this->shared_from_this(), queueElement, sendBuffer, offset](size_t bytesTransferred) mutable {
+            this->sendHandler(queueElement, std::move(sendBuffer), offset, bytesTransferred);
         },
-        [this, self = this->shared_from_this(), queueElement](const error::Error& e) mutable {
+        [this, self = this->shared_from_this(), queueElement, sendBuffer](const error::Error& e) mutable {
             queueElement->second->reject(e);
-            sendQueue_.erase(queueElement);
-
-            if(!sendQueue_.empty())
-            {
-                this->doSend(sendQueue_.begin(), 0);
-            }
+            this->finishSend(queueElement, std::move(sendBuffer));
         });
 
-    aoapDevice_->getOutEndpoint().bulkTransfer(common::DataBuffer(queueElement->first, offset), cSendTimeoutMs, std::move(usbEndpointPromise));
+    aoapDevice_->getOutEndpoint().bulkTransfer(buffer, cSendTimeoutMs, std::move(usbEndpointPromise));
 }
 
-void USBTransport::sendHandler(SendQueue::iterator queueElement, common::Data::size_type offset, size_t bytesTransferred)
+void USBTransport::sendHandler(SendQueue::iterator queueElement, usb::USBDeviceMemory::Pointer sendBuffer, common::Data::size_type offset, size_t bytesTransferred)
 {
-    if(offset + bytesTransferred < queueElement->first.size())
+    if(offset + bytesTransferred >= queueElement->first.size())
+    {
+        queueElement->second->resolve();
+        this->finishSend(queueElement, std::move(sendBuffer));
+    }
+    else if(pendingSendsCount_ == 1)
     {
-        this->doSend(queueElement, offset + bytesTransferred);
+        this->doSend(queueElement, std::move(sendBuffer), offset + bytesTransferred);
     }
     else
     {
-        queueElement->second->resolve();
-        sendQueue_.erase(queueElement);
+        // following elements are already on the wire, the rest of this one cannot be delivered in order anymore
+        aoapDevice_->getOutEndpoint().cancelTransfers();
+        queueElement->second->reject(error::Error(error::ErrorCode::USB_INCOMPLETE_TRANSFER));
+        this->finishSend(queueElement, std::move(sendBuffer));
+    }
+}
+
+void USBTransport::finishSend(SendQueue::iterator queueElement, usb::USBDeviceMemory::Pointer sendBuffer)
+{
+    if(sendBuffer != nullptr)
+    {
+        sendBuffers_.push_back(std::move(sendBuffer));
+    }
 
-        if(!sendQueue_.empty())
+    Transport::finishSend(queueElement);
+}
+
+usb::USBDeviceMemory::Pointer USBTransport::acquireSendBuffer(common::Data::size_type size)
+{
+    if(usbWrapper_ == nullptr || size > cDeviceSendBufferSize)
+    {
+        return nullptr;
+    }
+    else if(!sendBuffers_.empty())
+    {
+        auto sendBuffer = std::move(sendBuffers_.back());
+        sendBuffers_.pop_back();
+        return sendBuffer;
+    }
+
+    try
+    {
+        return std::make_shared<usb::USBDeviceMemory>(*usbWrapper_, aoapDevice_->getOutEndpoint().getDeviceHandle(), cDeviceSendBufferSize);
+    }
+    catch(const error::Error& e)
+    {
+        AASDK_LOG(warning) << "[USBTransport] device memory is not available, sending from heap memory: " << e.what();
+        usbWrapper_ = nullptr;
+        return nullptr;
+    }
+}
+
+IDataSinkStorage::Pointer USBTransport::createReceiveStorage(usb::IUSBWrapper& usbWrapper, usb::DeviceHandle handle, size_t size)
+{
+    const size_t mirrorSize = cDeviceReceiveMirrorSize;
+
+    try
+    {
+        return std::make_shared<USBDataSinkStorage>(usbWrapper, std::move(handle), size, std::min(size, mirrorSize));
+    }
+    catch(const error::Error& e)
+    {
+        AASDK_LOG(warning) << "[USBTransport] device memory is not available, receiving into heap memory: " << e.what();
+        return DataSink::createStorage(size);
+    }
+}
+
+void USBTransport::setReceiveQueueDepth(size_t depth)
+{
+    receiveStrand_.dispatch([this, self = this->shared_from_this(), depth]() {
+        receiveQueueDepth_ = std::max<size_t>(depth, 1);
+    });
+}
+
+void USBTransport::setSendQueueDepth(size_t depth)
+{
+    sendStrand_.dispatch([this, self = this->shared_from_this(), depth]() {
+        sendQueueDepth_ = std::max<size_t>(depth, 1);
+
+        if(!isSendHeld_)
         {
-            this->doSend(sendQueue_.begin(), 0);
+            this->sendNext();
         }
-    }
+    });
 }
 
 void USBTransport::stop()
 {
+    Transport::stop();
     aoapDevice_->getInEndpoint().cancelTransfers();
     aoapDevice_->getOutEndpoint().cancelTransfers();
 }
@@ -19,6 +19,7 @@
 #include <boost/test/unit_test.hpp>
 #include <f1x/aasdk/USB/UT/USBEndpoint.mock.hpp>
 #include <f1x/aasdk/USB/UT/AOAPDevice.mock.hpp>
+#include <f1x/aasdk/USB/UT/USBWrapper.mock.hpp>
 #include <f1x/aasdk/Transport/UT/TransportReceivePromiseHandler.mock.hpp>
 #include <f1x/aasdk/Transport/UT/TransportSendPromiseHandler.mock.hpp>
 #include <f1x/aasdk/Transport/USBTransport.hpp>
@@ -36,6 +37,9 @@ using ::testing::ReturnRef;
 using ::testing::SaveArg;
 using ::testing::_;
 using ::testing::AtLeast;
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::Return;
 
 class USBTransportUnitTest
 {
@@ -83,12 +87,55 @@ BOOST_FIXTURE_TEST_CASE(USBTransport_ReceiveAtOnce, USBTransportUnitTest)
     common::Data expectedData(receiveSize, 0x5E);
     std::copy(expectedData.begin(), expectedData.end(), dataBuffer.data);
 
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(expectedData)).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
     usbEndpointPromise->resolve(receiveSize);
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(USBTransport_ReceiveWithQueueDepth, USBTransportUnitTest)
+{
+    std::vector<common::DataBuffer> dataBuffers;
+    std::vector<usb::IUSBEndpoint::Promise::Pointer> usbEndpointPromises;
+    EXPECT_CALL(inEndpointMock_, bulkTransfer(_, _, _)).Times(AtLeast(4))
+            .WillRepeatedly(Invoke([&](auto buffer, auto, auto promise) {
+                dataBuffers.push_back(buffer);
+                usbEndpointPromises.push_back(std::move(promise));
+            }));
+
+    auto transport(std::make_shared<USBTransport>(ioService_, aoapDevice_));
+    transport->setReceiveQueueDepth(4);
+    transport->receive(300, std::move(receivePromise_));
+
+    auto secondPromise = ITransport::ReceivePromise::defer(ioService_);
+    TransportReceivePromiseHandlerMock secondPromiseHandlerMock;
+    secondPromise->then(std::bind(&TransportReceivePromiseHandlerMock::onResolve, &secondPromiseHandlerMock, std::placeholders::_1),
+                       std::bind(&TransportReceivePromiseHandlerMock::onReject, &secondPromiseHandlerMock, std::placeholders::_1));
+    transport->receive(200, std::move(secondPromise));
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_TEST(dataBuffers.size() == 4u);
+    std::fill(dataBuffers[0].data, dataBuffers[0].data + 100, 0x5E);
+    std::fill(dataBuffers[1].data, dataBuffers[1].data + 150, 0x5F);
+    std::fill(dataBuffers[2].data, dataBuffers[2].data + 250, 0x60);
+
+    common::Data expectedData(100, 0x5E);
+    expectedData.resize(250, 0x5F);
+    expectedData.resize(300, 0x60);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
+
+    const common::Data secondExpectedData(200, 0x60);
+    EXPECT_CALL(secondPromiseHandlerMock, onResolve(Eq(secondExpectedData))).Times(1);
+    EXPECT_CALL(secondPromiseHandlerMock, onReject(_)).Times(0);
+
+    usbEndpointPromises[0]->resolve(100);
+    usbEndpointPromises[1]->resolve(150);
+    usbEndpointPromises[2]->resolve(250);
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(USBTransport_ReceiveInPieces, USBTransportUnitTest)
 {
     const size_t stepsCount = 100;
@@ -104,7 +151,7 @@ BOOST_FIXTURE_TEST_CASE(USBTransport_ReceiveInPieces, USBTransportUnitTest)
             .WillRepeatedly(DoAll(SaveArg<0>(&dataBuffer), SaveArg<2>(&usbEndpointPromise)));
 
     common::Data expectedData(receiveSize, 0x5E);
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(expectedData)).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
 
     for(size_t i = 0; i < stepsCount; ++i)
@@ -148,11 +195,11 @@ BOOST_FIXTURE_TEST_CASE(USBTransport_OnlyOneReceiveAtATime, USBTransportUnitTest
     ioService_.reset();
 
     common::Data expectedData(stepSize, 0x5E);
-    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(expectedData)).Times(1);
+    EXPECT_CALL(receivePromiseHandlerMock_, onResolve(Eq(expectedData))).Times(1);
     EXPECT_CALL(receivePromiseHandlerMock_, onReject(_)).Times(0);
 
     common::Data secondExpectedData(stepSize, 0x5F);
-    EXPECT_CALL(secondPromiseHandlerMock, onResolve(secondExpectedData)).Times(1);
+    EXPECT_CALL(secondPromiseHandlerMock, onResolve(Eq(secondExpectedData))).Times(1);
     EXPECT_CALL(secondPromiseHandlerMock, onReject(_)).Times(0);
 
     usbEndpointPromise->resolve(receiveSize);
@@ -204,6 +251,49 @@ BOOST_FIXTURE_TEST_CASE(USBTransport_Send, USBTransportUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(USBTransport_SendSequence, USBTransportUnitTest)
+{
+    usb::IUSBEndpoint::Promise::Pointer usbEndpointPromise;
+    common::DataBuffer buffer;
+    EXPECT_CALL(outEndpointMock_, bulkTransfer(_, _, _)).WillOnce(DoAll(SaveArg<0>(&buffer), SaveArg<2>(&usbEndpointPromise)));
+
+    USBTransport::Pointer transport(std::make_shared<USBTransport>(ioService_, aoapDevice_));
+    common::Data expectedData(4, 0x5E);
+    expectedData.resize(1004, 0x5F);
+    transport->send(common::DataSequence(common::Data(4, 0x5E), common::DataSlice(common::Data(1000, 0x5F))), std::move(sendPromise_));
+    ioService_.run();
+    ioService_.reset();
+
+    common::Data actualData(buffer.data, buffer.data + buffer.size);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    usbEndpointPromise->resolve(expectedData.size());
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(USBTransport_SendStraightFromPayload, USBTransportUnitTest)
+{
+    usb::IUSBEndpoint::Promise::Pointer usbEndpointPromise;
+    common::DataBuffer buffer;
+    EXPECT_CALL(outEndpointMock_, bulkTransfer(_, _, _)).WillOnce(DoAll(SaveArg<0>(&buffer), SaveArg<2>(&usbEndpointPromise)));
+
+    USBTransport::Pointer transport(std::make_shared<USBTransport>(ioService_, aoapDevice_));
+    const common::DataSlice payload(common::Data(1000, 0x5F));
+    transport->send(common::DataSequence(common::Data(), payload), std::move(sendPromise_));
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_CHECK(buffer.data == payload.cdata);
+    BOOST_CHECK_EQUAL(buffer.size, payload.size);
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    usbEndpointPromise->resolve(payload.size);
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(USBTransport_SendInPieces, USBTransportUnitTest)
 {
     usb::IUSBEndpoint::Promise::Pointer usbEndpointPromise;
@@ -276,6 +366,77 @@ BOOST_FIXTURE_TEST_CASE(USBTransport_OnlyOneSendAtATime, USBTransportUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(USBTransport_PipelinedSends, USBTransportUnitTest)
+{
+    std::vector<common::DataBuffer> buffers;
+    std::vector<usb::IUSBEndpoint::Promise::Pointer> usbEndpointPromises;
+    EXPECT_CALL(outEndpointMock_, bulkTransfer(_, _, _)).Times(2)
+            .WillRepeatedly(Invoke([&](auto buffer, auto, auto promise) {
+                buffers.push_back(buffer);
+                usbEndpointPromises.push_back(std::move(promise));
+            }));
+
+    auto transport(std::make_shared<USBTransport>(ioService_, aoapDevice_));
+    transport->setSendQueueDepth(2);
+
+    const common::Data expectedData1(1000, 0x5E);
+    transport->send(expectedData1, std::move(sendPromise_));
+
+    const common::Data expectedData2(3000, 0x5F);
+    auto secondSendPromise = ITransport::SendPromise::defer(ioService_);
+    TransportSendPromiseHandlerMock secondSendPromiseHandlerMock;
+    secondSendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &secondSendPromiseHandlerMock),
+                           std::bind(&TransportSendPromiseHandlerMock::onReject, &secondSendPromiseHandlerMock, std::placeholders::_1));
+    transport->send(expectedData2, std::move(secondSendPromise));
+    ioService_.run();
+    ioService_.reset();
+
+    BOOST_TEST(buffers.size() == 2u);
+    common::Data actualData1(buffers[0].data, buffers[0].data + buffers[0].size);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData1.begin(), actualData1.end(), expectedData1.begin(), expectedData1.end());
+    common::Data actualData2(buffers[1].data, buffers[1].data + buffers[1].size);
+    BOOST_CHECK_EQUAL_COLLECTIONS(actualData2.begin(), actualData2.end(), expectedData2.begin(), expectedData2.end());
+
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+    EXPECT_CALL(secondSendPromiseHandlerMock, onReject(_)).Times(0);
+    EXPECT_CALL(secondSendPromiseHandlerMock, onResolve());
+    usbEndpointPromises[0]->resolve(expectedData1.size());
+    usbEndpointPromises[1]->resolve(expectedData2.size());
+    ioService_.run();
+}
+
+BOOST_FIXTURE_TEST_CASE(USBTransport_PipelinedSendIncompleteTransfer, USBTransportUnitTest)
+{
+    std::vector<usb::IUSBEndpoint::Promise::Pointer> usbEndpointPromises;
+    EXPECT_CALL(outEndpointMock_, bulkTransfer(_, _, _)).Times(2)
+            .WillRepeatedly(Invoke([&](auto, auto, auto promise) { usbEndpointPromises.push_back(std::move(promise)); }));
+
+    auto transport(std::make_shared<USBTransport>(ioService_, aoapDevice_));
+    transport->setSendQueueDepth(2);
+    transport->send(common::Data(1000, 0x5E), std::move(sendPromise_));
+
+    auto secondSendPromise = ITransport::SendPromise::defer(ioService_);
+    TransportSendPromiseHandlerMock secondSendPromiseHandlerMock;
+    secondSendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &secondSendPromiseHandlerMock),
+                           std::bind(&TransportSendPromiseHandlerMock::onReject, &secondSendPromiseHandlerMock, std::placeholders::_1));
+    transport->send(common::Data(3000, 0x5F), std::move(secondSendPromise));
+    ioService_.run();
+    ioService_.reset();
+
+    EXPECT_CALL(outEndpointMock_, cancelTransfers());
+    EXPECT_CALL(sendPromiseHandlerMock_, onReject(error::Error(error::ErrorCode::USB_INCOMPLETE_TRANSFER)));
+    EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(0);
+    usbEndpointPromises[0]->resolve(500);
+    ioService_.run();
+    ioService_.reset();
+
+    EXPECT_CALL(secondSendPromiseHandlerMock, onReject(error::Error(error::ErrorCode::OPERATION_ABORTED)));
+    EXPECT_CALL(secondSendPromiseHandlerMock, onResolve()).Times(0);
+    usbEndpointPromises[1]->reject(error::Error(error::ErrorCode::OPERATION_ABORTED));
+    ioService_.run();
+}
+
 BOOST_FIXTURE_TEST_CASE(USBTransport_SendError, USBTransportUnitTest)
 {
     usb::IUSBEndpoint::Promise::Pointer usbEndpointPromise;
@@ -310,6 +471,104 @@ BOOST_FIXTURE_TEST_CASE(USBTransport_SendError, USBTransportUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(USBTransport_TransfersFromDeviceMemory, USBTransportUnitTest)
+{
+    const size_t receiveBufferSize = 128 * 1024;
+    common::Data receiveMemory(receiveBufferSize + 64 * 1024);
+    common::Data sendMemory(32 * 1024);
+
+    usb::ut::USBWrapperMock usbWrapperMock;
+    EXPECT_CALL(inEndpointMock_, getDeviceHandle()).Times(AtLeast(1));
+    EXPECT_CALL(outEndpointMock_, getDeviceHandle()).Times(AtLeast(1));
+    EXPECT_CALL(usbWrapperMock, devMemAlloc(_, receiveMemory.size())).WillOnce(Return(&receiveMemory[0]));
+    EXPECT_CALL(usbWrapperMock, devMemAlloc(_, sendMemory.size())).WillOnce(Return(&sendMemory[0]));
+
+    usb::IUSBEndpoint::Promise::Pointer receiveEndpointPromise;
+    common::DataBuffer receiveBuffer;
+    EXPECT_CALL(inEndpointMock_, bulkTransfer(_, _, _)).WillOnce(DoAll(SaveArg<0>(&receiveBuffer), SaveArg<2>(&receiveEndpointPromise)));
+
+    usb::IUSBEndpoint::Promise::Pointer sendEndpointPromise;
+    common::DataBuffer sendBuffer;
+    EXPECT_CALL(outEndpointMock_, bulkTransfer(_, _, _)).Times(2).WillRepeatedly(DoAll(SaveArg<0>(&sendBuffer), SaveArg<2>(&sendEndpointPromise)));
+
+    {
+        auto transport(std::make_shared<USBTransport>(ioService_, aoapDevice_, usbWrapperMock, receiveBufferSize));
+        transport->receive(100, std::move(receivePromise_));
+        transport->send(common::DataSequence(common::Data(4, 0x5E), common::DataSlice(common::Data(1000, 0x5F))), std::move(sendPromise_));
+        ioService_.run();
+        ioService_.reset();
+
+        BOOST_CHECK(receiveBuffer.data >= &receiveMemory[0] && receiveBuffer.data + receiveBuffer.size <= &receiveMemory[0] + receiveMemory.size());
+        BOOST_CHECK(sendBuffer.data == &sendMemory[0]);
+        BOOST_CHECK_EQUAL(sendBuffer.size, 1004u);
+
+        common::Data expectedData(4, 0x5E);
+        expectedData.resize(1004, 0x5F);
+        common::Data actualData(sendBuffer.data, sendBuffer.data + sendBuffer.size);
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
+
+        EXPECT_CALL(sendPromiseHandlerMock_, onReject(_)).Times(0);
+        EXPECT_CALL(sendPromiseHandlerMock_, onResolve()).Times(2);
+        sendEndpointPromise->resolve(sendBuffer.size);
+        ioService_.run();
+        ioService_.reset();
+
+        // send memory is reused by the next transfer
+        auto sendPromise = ITransport::SendPromise::defer(ioService_);
+        sendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock_),
+                          std::bind(&TransportSendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
+        transport->send(common::Data(200, 0x60), std::move(sendPromise));
+        ioService_.run();
+        ioService_.reset();
+
+        BOOST_CHECK(sendBuffer.data == &sendMemory[0]);
+        BOOST_CHECK_EQUAL(sendBuffer.size, 200u);
+        sendEndpointPromise->resolve(sendBuffer.size);
+        ioService_.run();
+        ioService_.reset();
+
+        EXPECT_CALL(usbWrapperMock, devMemFree(_, &receiveMemory[0], receiveMemory.size()));
+        EXPECT_CALL(usbWrapperMock, devMemFree(_, &sendMemory[0], sendMemory.size()));
+        EXPECT_CALL(receivePromiseHandlerMock_, onReject(_));
+        receiveEndpointPromise->reject(error::Error(error::ErrorCode::OPERATION_ABORTED));
+        ioService_.run();
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(USBTransport_DeviceMemoryNotAvailable, USBTransportUnitTest)
+{
+    usb::ut::USBWrapperMock usbWrapperMock;
+    EXPECT_CALL(inEndpointMock_, getDeviceHandle()).Times(AtLeast(1));
+    EXPECT_CALL(outEndpointMock_, getDeviceHandle()).Times(AtLeast(1));
+    EXPECT_CALL(usbWrapperMock, devMemAlloc(_, _)).Times(2).WillRepeatedly(Return(nullptr));
+    EXPECT_CALL(usbWrapperMock, devMemFree(_, _, _)).Times(0);
+
+    usb::IUSBEndpoint::Promise::Pointer usbEndpointPromise;
+    common::DataBuffer buffer;
+    EXPECT_CALL(outEndpointMock_, bulkTransfer(_, _, _)).Times(2).WillRepeatedly(DoAll(SaveArg<0>(&buffer), SaveArg<2>(&usbEndpointPromise)));
+
+    auto transport(std::make_shared<USBTransport>(ioService_, aoapDevice_, usbWrapperMock));
+    common::Data expectedData(1000, 0x5E);
+
+    for(size_t i = 0; i < 2; ++i)
+    {
+        auto sendPromise = ITransport::SendPromise::defer(ioService_);
+        sendPromise->then(std::bind(&TransportSendPromiseHandlerMock::onResolve, &sendPromiseHandlerMock_),
+                          std::bind(&TransportSendPromiseHandlerMock::onReject, &sendPromiseHandlerMock_, std::placeholders::_1));
+        transport->send(expectedData, std::move(sendPromise));
+        ioService_.run();
+        ioService_.reset();
+
+        common::Data actualData(buffer.data, buffer.data + buffer.size);
+        BOOST_CHECK_EQUAL_COLLECTIONS(actualData.begin(), actualData.end(), expectedData.begin(), expectedData.end());
+
+        EXPECT_CALL(sendPromiseHandlerMock_, onResolve());
+        usbEndpointPromise->resolve(buffer.size);
+        ioService_.run();
+        ioService_.reset();
+    }
+}
+
 }
 }
 }
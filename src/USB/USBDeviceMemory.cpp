@@ -0,0 +1,58 @@
+/*
+*  This file is part of aasdk library project.
+*  Copyright (C) 2018 f1x.studio (Michal Szwaj)
+*
+*  aasdk is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 3 of the License, or
+*  (at your option) any later version.
+
+*  aasdk is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with aasdk. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <f1x/aasdk/USB/USBDeviceMemory.hpp>
+#include <f1x/aasdk/Error/Error.hpp>
+
+namespace f1x
+{
+namespace aasdk
+{
+namespace usb
+{
+
+USBDeviceMemory::USBDeviceMemory(IUSBWrapper& usbWrapper, DeviceHandle handle, common::Data::size_type size)
+    : usbWrapper_(usbWrapper)
+    , handle_(std::move(handle))
+    , data_(usbWrapper_.devMemAlloc(handle_, size))
+    , size_(size)
+{
+    if(data_ == nullptr)
+    {
+        throw error::Error(error::ErrorCode::USB_DEVICE_MEMORY_ALLOCATION);
+    }
+}
+
+USBDeviceMemory::~USBDeviceMemory()
+{
+    usbWrapper_.devMemFree(handle_, data_, size_);
+}
+
+common::Data::value_type* USBDeviceMemory::getData()
+{
+    return data_;
+}
+
+common::Data::size_type USBDeviceMemory::getSize() const
+{
+    return size_;
+}
+
+}
+}
+}
@@ -35,6 +35,17 @@ USBEndpoint::USBEndpoint(IUSBWrapper& usbWrapper, boost::asio::io_service& ioSer
 {
 }
 
+USBEndpoint::~USBEndpoint()
+{
+    idleTransfers_.clear();
+    pendingTransfers_.clear();
+
+    for(auto& transfer : transfers_)
+    {
+        usbWrapper_.freeTransfer(transfer.handle);
+    }
+}
+
 void USBEndpoint::controlTransfer(common::DataBuffer buffer, uint32_t timeout, Promise::Pointer promise)
 {
     if(endpointAddress_ != 0)
@@ -43,16 +54,7 @@ void USBEndpoint::controlTransfer(common::DataBuffer buffer, uint32_t timeout, P
     }
     else
     {
-        auto* transfer = usbWrapper_.allocTransfer(0);
-        if(transfer == nullptr)
-        {
-            promise->reject(error::Error(error::ErrorCode::USB_TRANSFER_ALLOCATION));
-        }
-        else
-        {
-            usbWrapper_.fillControlTransfer(transfer, handle_, buffer.data, reinterpret_cast<libusb_transfer_cb_fn>(&USBEndpoint::transferHandler), this, timeout);
-            this->transfer(transfer, std::move(promise));
-        }
+        this->transfer(TransferType::CONTROL, std::move(buffer), timeout, std::move(promise));
     }
 }
 
@@ -64,16 +66,7 @@ void USBEndpoint::interruptTransfer(common::DataBuffer buffer, uint32_t timeout,
     }
     else
     {
-        auto* transfer = usbWrapper_.allocTransfer(0);
-        if(transfer == nullptr)
-        {
-            promise->reject(error::Error(error::ErrorCode::USB_TRANSFER_ALLOCATION));
-        }
-        else
-        {
-            usbWrapper_.fillInterruptTransfer(transfer, handle_, endpointAddress_, buffer.data, buffer.size, reinterpret_cast<libusb_transfer_cb_fn>(&USBEndpoint::transferHandler), this, timeout);
-            this->transfer(transfer, std::move(promise));
-        }
+        this->transfer(TransferType::INTERRUPT, std::move(buffer), timeout, std::move(promise));
     }
 }
 
@@ -85,23 +78,22 @@ void USBEndpoint::bulkTransfer(common::DataBuffer buffer, uint32_t timeout, Prom
     }
     else
     {
-        auto* transfer = usbWrapper_.allocTransfer(0);
+        this->transfer(TransferType::BULK, std::move(buffer), timeout, std::move(promise));
+    }
+}
+
+void USBEndpoint::transfer(TransferType type, common::DataBuffer buffer, uint32_t timeout, Promise::Pointer promise)
+{
+    strand_.dispatch([this, self = this->shared_from_this(), type, buffer = std::move(buffer), timeout, promise = std::move(promise)]() mutable {
+        auto* transfer = this->acquireTransfer();
         if(transfer == nullptr)
         {
             promise->reject(error::Error(error::ErrorCode::USB_TRANSFER_ALLOCATION));
+            return;
         }
-        else
-        {
-            usbWrapper_.fillBulkTransfer(transfer, handle_, endpointAddress_, buffer.data, buffer.size, reinterpret_cast<libusb_transfer_cb_fn>(&USBEndpoint::transferHandler), this, timeout);
-            this->transfer(transfer, std::move(promise));
-        }
-    }
-}
 
-void USBEndpoint::transfer(libusb_transfer *transfer, Promise::Pointer promise)
-{
-    strand_.dispatch([this, self = this->shared_from_this(), transfer, promise = std::move(promise)]() mutable {
-        auto submitResult = usbWrapper_.submitTransfer(transfer);
+        this->fillTransfer(*transfer, type, std::move(buffer), timeout);
+        auto submitResult = usbWrapper_.submitTransfer(transfer->handle);
 
         if(submitResult == 0)
         {
@@ -111,16 +103,51 @@ void USBEndpoint::transfer(libusb_transfer *transfer, Promise::Pointer promise)
                 self_ = std::move(self);
             }
 
-            transfers_.insert(std::make_pair(transfer, std::move(promise)));
+            transfer->promise = std::move(promise);
+            pendingTransfers_.splice(pendingTransfers_.end(), idleTransfers_, idleTransfers_.iterator_to(*transfer));
         }
         else
         {
             promise->reject(error::Error(error::ErrorCode::USB_TRANSFER, submitResult));
-            usbWrapper_.freeTransfer(transfer);
         }
     });
 }
 
+USBEndpoint::Transfer* USBEndpoint::acquireTransfer()
+{
+    if(idleTransfers_.empty())
+    {
+        auto* handle = usbWrapper_.allocTransfer(0);
+        if(handle == nullptr)
+        {
+            return nullptr;
+        }
+
+        transfers_.emplace_back(*this, handle);
+        idleTransfers_.push_back(transfers_.back());
+    }
+
+    return &idleTransfers_.back();
+}
+
+void USBEndpoint::fillTransfer(Transfer& transfer, TransferType type, common::DataBuffer buffer, uint32_t timeout)
+{
+    auto callback = reinterpret_cast<libusb_transfer_cb_fn>(&USBEndpoint::transferHandler);
+
+    switch(type)
+    {
+    case TransferType::CONTROL:
+        usbWrapper_.fillControlTransfer(transfer.handle, handle_, buffer.data, callback, &transfer, timeout);
+        break;
+    case TransferType::BULK:
+        usbWrapper_.fillBulkTransfer(transfer.handle, handle_, endpointAddress_, buffer.data, buffer.size, callback, &transfer, timeout);
+        break;
+    case TransferType::INTERRUPT:
+        usbWrapper_.fillInterruptTransfer(transfer.handle, handle_, endpointAddress_, buffer.data, buffer.size, callback, &transfer, timeout);
+        break;
+    }
+}
+
 uint8_t USBEndpoint::getAddress()
 {
     return endpointAddress_;
@@ -129,9 +156,9 @@ uint8_t USBEndpoint::getAddress()
 void USBEndpoint::cancelTransfers()
 {
     strand_.dispatch([this, self = this->shared_from_this()]() mutable {
-        for(const auto& transfer : transfers_)
+        for(auto& transfer : pendingTransfers_)
         {
-            usbWrapper_.cancelTransfer(transfer.first);
+            usbWrapper_.cancelTransfer(transfer.handle);
         }
     });
 }
@@ -143,15 +170,18 @@ DeviceHandle USBEndpoint::getDeviceHandle() const
 
 void USBEndpoint::transferHandler(libusb_transfer *transfer)
 {
-    auto self = reinterpret_cast<USBEndpoint*>(transfer->user_data)->shared_from_this();
+    auto& pendingTransfer = *reinterpret_cast<Transfer*>(transfer->user_data);
+    auto self = pendingTransfer.endpoint.shared_from_this();
 
-    self->strand_.dispatch([self, transfer]() mutable {
-        if(self->transfers_.count(transfer) == 0)
+    self->strand_.dispatch([self, &pendingTransfer, transfer]() mutable {
+        if(pendingTransfer.promise == nullptr)
         {
             return;
         }
 
-        auto promise(std::move(self->transfers_.at(transfer)));
+        auto promise(std::move(pendingTransfer.promise));
+        pendingTransfer.promise.reset();
+        self->idleTransfers_.splice(self->idleTransfers_.end(), self->pendingTransfers_, self->pendingTransfers_.iterator_to(pendingTransfer));
 
         if(transfer->status == LIBUSB_TRANSFER_COMPLETED)
         {
@@ -163,16 +193,19 @@ void USBEndpoint::transferHandler(libusb_transfer *transfer)
             promise->reject(error);
         }
 
-        self->usbWrapper_.freeTransfer(transfer);
-        self->transfers_.erase(transfer);
-
-        if(self->transfers_.empty())
+        if(self->pendingTransfers_.empty())
         {
             self->self_.reset();
         }
     });
 }
 
+USBEndpoint::Transfer::Transfer(USBEndpoint& endpoint, libusb_transfer* handle)
+    : endpoint(endpoint)
+    , handle(handle)
+{
+}
+
 }
 }
 }
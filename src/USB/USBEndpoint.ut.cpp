@@ -165,14 +165,14 @@ BOOST_FIXTURE_TEST_CASE(USBEndpoint_MultipleBulkTransfers, USBEndpointUnitTest)
     USBEndpoint::Pointer usbEndpoint(std::make_shared<USBEndpoint>(usbWrapperMock_, ioService_, deviceHandle_, endpointAddress));
 
     libusb_transfer transfer;
-    EXPECT_CALL(usbWrapperMock_, allocTransfer(0)).WillRepeatedly(Return(&transfer));
+    EXPECT_CALL(usbWrapperMock_, allocTransfer(0)).WillOnce(Return(&transfer));
 
     const size_t attemptsCount = 1000;
 
     libusb_transfer_cb_fn transferCallback;
 
     EXPECT_CALL(usbWrapperMock_, submitTransfer(&transfer)).Times(attemptsCount);
-    EXPECT_CALL(usbWrapperMock_, freeTransfer(&transfer)).Times(attemptsCount);
+    EXPECT_CALL(usbWrapperMock_, freeTransfer(&transfer)).Times(1);
     EXPECT_CALL(promiseHandlerMock_, onReject(_)).Times(0);
 
     for(size_t i = 0; i < attemptsCount; ++i)
@@ -288,6 +288,53 @@ BOOST_FIXTURE_TEST_CASE(USBEndpoint_BulkTransferFailed, USBEndpointUnitTest)
     ioService_.run();
 }
 
+BOOST_FIXTURE_TEST_CASE(USBEndpoint_CancelConcurrentBulkTransfers, USBEndpointUnitTest)
+{
+    const uint8_t endpointAddress = 0x55;
+    USBEndpoint::Pointer usbEndpoint(std::make_shared<USBEndpoint>(usbWrapperMock_, ioService_, deviceHandle_, endpointAddress));
+
+    libusb_transfer transfers[2];
+    EXPECT_CALL(usbWrapperMock_, allocTransfer(0)).WillOnce(Return(&transfers[0])).WillOnce(Return(&transfers[1]));
+
+    libusb_transfer_cb_fn transferCallback;
+    common::Data data(10, 0);
+    common::DataBuffer buffer(data);
+    EXPECT_CALL(usbWrapperMock_, fillBulkTransfer(&transfers[0], _, endpointAddress, buffer.data, buffer.size, _, _, _))
+            .WillOnce(DoAll(SaveArg<5>(&transferCallback), SaveArg<6>(&transfers[0].user_data)));
+    EXPECT_CALL(usbWrapperMock_, fillBulkTransfer(&transfers[1], _, endpointAddress, buffer.data, buffer.size, _, _, _))
+            .WillOnce(SaveArg<6>(&transfers[1].user_data));
+    EXPECT_CALL(usbWrapperMock_, submitTransfer(&transfers[0]));
+    EXPECT_CALL(usbWrapperMock_, submitTransfer(&transfers[1]));
+
+    auto secondPromise = IUSBEndpoint::Promise::defer(ioService_);
+    secondPromise->then(std::bind(&USBEndpointPromiseHandlerMock::onResolve, &promiseHandlerMock_, std::placeholders::_1),
+                        std::bind(&USBEndpointPromiseHandlerMock::onReject, &promiseHandlerMock_, std::placeholders::_1));
+
+    usbEndpoint->bulkTransfer(common::DataBuffer(data), 0, std::move(promise_));
+    usbEndpoint->bulkTransfer(common::DataBuffer(data), 0, std::move(secondPromise));
+    ioService_.run();
+    ioService_.reset();
+
+    EXPECT_CALL(usbWrapperMock_, cancelTransfer(&transfers[0]));
+    EXPECT_CALL(usbWrapperMock_, cancelTransfer(&transfers[1]));
+    usbEndpoint->cancelTransfers();
+    ioService_.run();
+    ioService_.reset();
+
+    for(auto& transfer : transfers)
+    {
+        transfer.actual_length = 0;
+        transfer.status = LIBUSB_TRANSFER_CANCELLED;
+        transferCallback(&transfer);
+    }
+
+    EXPECT_CALL(usbWrapperMock_, freeTransfer(&transfers[0]));
+    EXPECT_CALL(usbWrapperMock_, freeTransfer(&transfers[1]));
+    EXPECT_CALL(promiseHandlerMock_, onReject(error::Error(error::ErrorCode::OPERATION_ABORTED))).Times(2);
+    EXPECT_CALL(promiseHandlerMock_, onResolve(_)).Times(0);
+    ioService_.run();
+}
+
 }
 }
 }
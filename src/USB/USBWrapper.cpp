@@ -168,6 +168,24 @@ libusb_transfer* USBWrapper::allocTransfer(int iso_packets)
     return libusb_alloc_transfer(iso_packets);
 }
 
+unsigned char* USBWrapper::devMemAlloc(const DeviceHandle& dev_handle, size_t length)
+{
+#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+    return libusb_dev_mem_alloc(dev_handle.get(), length);
+#else
+    return nullptr;
+#endif
+}
+
+int USBWrapper::devMemFree(const DeviceHandle& dev_handle, unsigned char *buffer, size_t length)
+{
+#if defined(LIBUSB_API_VERSION) && LIBUSB_API_VERSION >= 0x01000105
+    return libusb_dev_mem_free(dev_handle.get(), buffer, length);
+#else
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+#endif
+}
+
 }
 }
 }